@@ -2,9 +2,39 @@
  * @file mc_clock.c
  */
 
+#if !defined(_POSIX_C_SOURCE) && !defined(_GNU_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
 #include "mc_clock.h"
 #include <stdlib.h>
 
+#include <string.h>
+
+#if defined(MC_CLOCK_SYSTEM) || defined(MC_CLOCK_STATS)
+#include <time.h>
+#endif
+
+#ifdef MC_CLOCK_SNAPSHOT_FILES
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef MC_CLOCK_THREADS
+#include <pthread.h>
+#endif
+
+#ifdef MC_CLOCK_STATS
+#include <stdarg.h>
+#include <stdio.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#endif
+
 // 01/jan/2020 12:00:00 AM
 #define DEFAULT_TIMESTAMP ((int32_t)1577836800)
 
@@ -16,13 +46,111 @@ typedef struct
     uint8_t hour;
     uint8_t minute;
     uint8_t second;
+    uint8_t flags;  // CLOCK_FLAG_*, kept by datetime updates. 0 in snapshot records
 } clock_datetime_t;
 
 typedef struct
 {
     int32_t timestamp;
     clock_datetime_t datetime;
-} clock_t;
+} mc_clock_t;
+
+// clock allocated by Mc_Clock_New (clock_object_t), not a snapshot record
+#define CLOCK_FLAG_OBJECT   0x01
+// rollover callbacks registered
+#define CLOCK_FLAG_EVENTS   0x02
+
+typedef struct
+{
+    mc_clock_rollover_callback_t callback[MC_CLOCK_LEVEL_COUNT];
+    void *context[MC_CLOCK_LEVEL_COUNT];
+    uint8_t replay;     // bit per level: one call per boundary crossed
+} clock_events_t;
+
+typedef struct
+{
+    mc_clock_t clock;
+    clock_events_t *events;
+} clock_object_t;
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_THREADS__)
+#define MC_CLOCK_THREAD_LOCAL _Thread_local
+#elif defined(__GNUC__)
+#define MC_CLOCK_THREAD_LOCAL __thread
+#else
+#define MC_CLOCK_THREAD_LOCAL
+#endif
+
+#ifdef MC_CLOCK_STATS
+
+// time one conversion out of MC_CLOCK_STATS_SAMPLE_RATE (power of 2)
+#ifndef MC_CLOCK_STATS_SAMPLE_RATE
+#define MC_CLOCK_STATS_SAMPLE_RATE 64
+#endif
+
+static MC_CLOCK_THREAD_LOCAL mc_clock_stats_t stats_counters;
+
+static uint64_t stats_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#else
+    return 0;
+#endif
+}// end stats_cycles
+
+static uint64_t stats_sample_begin(mc_clock_stats_conversion_t *c)
+{
+    if ((c->conversions++ & (MC_CLOCK_STATS_SAMPLE_RATE - 1)) != 0)
+        return 0;
+
+    c->samples++;
+    return stats_cycles();
+}// end stats_sample_begin
+
+static void stats_sample_end(mc_clock_stats_conversion_t *c, uint64_t start)
+{
+    if (start != 0)
+        c->cycles += stats_cycles() - start;
+}// end stats_sample_end
+
+#define STAT_CALL(fn) (stats_counters.calls[(fn)]++)
+#define STAT_ADD(dir, field, n) (stats_counters.dir.field += (n))
+#define STAT_SAMPLE_BEGIN(dir) uint64_t _stat_start = stats_sample_begin(&stats_counters.dir)
+#define STAT_SAMPLE_END(dir) stats_sample_end(&stats_counters.dir, _stat_start)
+
+#else
+
+#define STAT_CALL(fn) ((void)0)
+#define STAT_ADD(dir, field, n) ((void)0)
+#define STAT_SAMPLE_BEGIN(dir) ((void)0)
+#define STAT_SAMPLE_END(dir) ((void)0)
+
+#endif /* MC_CLOCK_STATS */
+
+#ifdef MC_CLOCK_DAY_CACHE
+
+#if (MC_CLOCK_DAY_CACHE) <= 0 || ((MC_CLOCK_DAY_CACHE) & ((MC_CLOCK_DAY_CACHE) - 1)) != 0
+#error "MC_CLOCK_DAY_CACHE must be a power of 2"
+#endif
+
+typedef struct
+{
+    int32_t days;   // days since 1/jan/1970
+    uint16_t year;  // 0: empty entry
+    uint8_t month;
+    uint8_t day;
+} day_cache_entry_t;
+
+// direct mapped by day number
+static MC_CLOCK_THREAD_LOCAL day_cache_entry_t day_cache[MC_CLOCK_DAY_CACHE];
+static MC_CLOCK_THREAD_LOCAL mc_clock_day_cache_stats_t day_cache_stats;
+
+#endif /* MC_CLOCK_DAY_CACHE */
 
 
 // ##############################  PRIVATE FUNCTIONS  ################################# //
@@ -45,22 +173,61 @@ static uint8_t days_in_month(uint8_t month, uint16_t year)
     return dim[month - 1];
 }// end days_in_month
 
+// start of the period of <length> seconds holding timestamp (floor, also before 1970)
+static int64_t period_floor(int64_t timestamp, int64_t length)
+{
+    int64_t rem = timestamp % length;
+    return timestamp - (rem < 0 ? rem + length : rem);
+}// end period_floor
+
+static int32_t timestamp_days(int64_t timestamp)
+{
+    return (int32_t)(period_floor(timestamp, 86400LL) / 86400LL);
+}// end timestamp_days
+
+// 0 = sunday. 1/jan/1970 was a thursday
+static uint8_t days_weekday(int32_t days)
+{
+    return (uint8_t)(((days + 4) % 7 + 7) % 7);
+}// end days_weekday
+
+static void split_time_of_day(uint32_t seconds, uint8_t *hour, uint8_t *minute, uint8_t *second)
+{
+    // seconds / 3600 and rest / 60 as multiply and shift (exact for seconds < 86400 and rest < 3600)
+    uint32_t h = (seconds * 37283u) >> 27;
+    uint32_t rest = seconds - h * 3600;
+    uint32_t m = (rest * 17477u) >> 20;
+
+    *hour = (uint8_t)h;
+    *minute = (uint8_t)m;
+    *second = (uint8_t)(rest - m * 60);
+}// end split_time_of_day
+
 static clock_datetime_t Mc_Clock_Timestamp_To_Human_Date(int32_t timestamp)
 {
+    STAT_SAMPLE_BEGIN(to_human_date);
     clock_datetime_t t;
-    int64_t days = timestamp / 86400LL;
-    int64_t seconds = timestamp % 86400LL;
+    t.flags = 0;
+    int64_t days = timestamp_days(timestamp);
+    split_time_of_day((uint32_t)(timestamp - days * 86400LL), &t.hour, &t.minute, &t.second);
+
+#ifdef MC_CLOCK_DAY_CACHE
+    day_cache_entry_t *entry = &day_cache[days & (MC_CLOCK_DAY_CACHE - 1)];
 
-    if (seconds < 0)
+    if (entry->year != 0 && entry->days == days)
     {
-        seconds += 86400LL;
-        days -= 1;
+        day_cache_stats.hits++;
+        t.year = entry->year;
+        t.month = entry->month;
+        t.day = entry->day;
+
+        STAT_SAMPLE_END(to_human_date);
+        return t;
     }
 
-    t.hour = (uint8_t)(seconds / 3600);
-    seconds %= 3600;
-    t.minute = (uint8_t)(seconds / 60);
-    t.second = (uint8_t)(seconds % 60);
+    day_cache_stats.misses++;
+    entry->days = (int32_t)days;
+#endif
 
     int32_t year = 1970;
 
@@ -69,6 +236,7 @@ static clock_datetime_t Mc_Clock_Timestamp_To_Human_Date(int32_t timestamp)
         while (1)
         {
             int32_t dim = is_leap_year(year) ? 366 : 365;
+            STAT_ADD(to_human_date, year_iterations, 1);
             if (days < dim)
                 break;
             days -= dim;
@@ -81,6 +249,7 @@ static clock_datetime_t Mc_Clock_Timestamp_To_Human_Date(int32_t timestamp)
         {
             int32_t prev_year = year - 1;
             int32_t dim = is_leap_year(prev_year) ? 366 : 365;
+            STAT_ADD(to_human_date, year_iterations, 1);
             days += dim;
             if (days >= 0)
             {
@@ -97,6 +266,7 @@ static clock_datetime_t Mc_Clock_Timestamp_To_Human_Date(int32_t timestamp)
     while (1)
     {
         uint8_t dim = days_in_month(t.month, t.year);
+        STAT_ADD(to_human_date, month_iterations, 1);
         if (days < dim)
             break;
         days -= dim;
@@ -105,25 +275,36 @@ static clock_datetime_t Mc_Clock_Timestamp_To_Human_Date(int32_t timestamp)
 
     t.day = (uint8_t)(days + 1);
 
+#ifdef MC_CLOCK_DAY_CACHE
+    entry->year = t.year;
+    entry->month = t.month;
+    entry->day = t.day;
+#endif
+
+    STAT_SAMPLE_END(to_human_date);
     return t;
 }// end Mc_Clock_Timestamp_To_Human_Date
 
 static int32_t Mc_Clock_Human_Date_To_Timestamp(const clock_datetime_t *t)
 {
+    STAT_SAMPLE_BEGIN(to_timestamp);
     int64_t days = 0;
     int32_t year = t->year;
 
     if (year >= 1970)
     {
+        STAT_ADD(to_timestamp, year_iterations, year - 1970);
         for (int y = 1970; y < year; y++)
             days += is_leap_year(y) ? 366 : 365;
     }
     else
     {
+        STAT_ADD(to_timestamp, year_iterations, 1970 - year);
         for (int y = 1969; y >= year; y--)
             days -= is_leap_year(y) ? 366 : 365;
     }
 
+    STAT_ADD(to_timestamp, month_iterations, t->month - 1);
     for (uint8_t m = 1; m < t->month; m++)
         days += days_in_month(m, t->year);
 
@@ -136,9 +317,120 @@ static int32_t Mc_Clock_Human_Date_To_Timestamp(const clock_datetime_t *t)
     else if (timestamp < INT32_MIN)
         timestamp = INT32_MIN;
 
+    STAT_SAMPLE_END(to_timestamp);
     return (int32_t)timestamp;
 }// end Mc_Clock_Human_Date_To_Timestamp
 
+// replace datetime, keeping the clock flags
+static void set_datetime(mc_clock_t *_clock, clock_datetime_t t)
+{
+    t.flags = _clock->datetime.flags;
+    _clock->datetime = t;
+}// end set_datetime
+
+static void clamp_day(clock_datetime_t *t)
+{
+    uint8_t dim = days_in_month(t->month, t->year);
+    if (t->day > dim)
+        t->day = dim;
+}// end clamp_day
+
+static int32_t rollover_period_start(const mc_clock_t *_clock, mc_clock_level_t level)
+{
+    static const int32_t length[3] = {60, 3600, 86400};
+    const clock_datetime_t *t = &(_clock->datetime);
+    int64_t start;
+
+    if (level <= MC_CLOCK_LEVEL_DAY)
+        return (int32_t)period_floor(_clock->timestamp, length[level]);
+
+    start = (int64_t)Mc_Clock_Date_To_Days(t->year, (level == MC_CLOCK_LEVEL_MONTH) ? t->month : 1, 1) * 86400LL;
+    return (start < INT32_MIN) ? INT32_MIN : (int32_t)start;
+}// end rollover_period_start
+
+// call back every boundary of <level> in (from, to]
+static void rollover_replay(mc_clock_t *_clock, const clock_events_t *events, mc_clock_level_t level,
+                            const clock_datetime_t *from, int32_t from_timestamp)
+{
+    static const int64_t length[3] = {60, 3600, 86400};
+    int64_t to = _clock->timestamp;
+
+    if (level <= MC_CLOCK_LEVEL_DAY)
+    {
+        int64_t boundary = period_floor(from_timestamp, length[level]) + length[level];
+
+        for (; boundary <= to; boundary += length[level])
+            events->callback[level](_clock, level, (int32_t)boundary, events->context[level]);
+        return;
+    }
+
+    // month or year boundaries
+    int32_t year = from->year;
+    int32_t month = from->month;
+    while (1)
+    {
+        if (level == MC_CLOCK_LEVEL_YEAR || month == 12)
+        {
+            year++;
+            month = 1;
+        }
+        else
+        {
+            month++;
+        }
+
+        int64_t boundary = (int64_t)Mc_Clock_Date_To_Days((uint16_t)year, (uint8_t)month, 1) * 86400LL;
+        if (boundary > to)
+            return;
+
+        events->callback[level](_clock, level, (int32_t)boundary, events->context[level]);
+    }
+}// end rollover_replay
+
+static void rollover_dispatch(mc_clock_t *_clock, const clock_datetime_t *old, int32_t old_timestamp)
+{
+    const clock_events_t *events = ((clock_object_t *)_clock)->events;
+    const clock_datetime_t *t = &(_clock->datetime);
+    mc_clock_level_t top;
+
+    // coarsest field that changed: every finer level rolled over too
+    if (t->year != old->year)
+        top = MC_CLOCK_LEVEL_YEAR;
+    else if (t->month != old->month)
+        top = MC_CLOCK_LEVEL_MONTH;
+    else if (t->day != old->day)
+        top = MC_CLOCK_LEVEL_DAY;
+    else if (t->hour != old->hour)
+        top = MC_CLOCK_LEVEL_HOUR;
+    else if (t->minute != old->minute)
+        top = MC_CLOCK_LEVEL_MINUTE;
+    else
+        return;
+
+    for (int level = MC_CLOCK_LEVEL_MINUTE; level <= (int)top; level++)
+    {
+        if (events->callback[level] == NULL)
+            continue;
+
+        // replay only forward moves
+        if ((events->replay & (1 << level)) && _clock->timestamp > old_timestamp)
+            rollover_replay(_clock, events, (mc_clock_level_t)level, old, old_timestamp);
+        else
+            events->callback[level](_clock, (mc_clock_level_t)level, rollover_period_start(_clock, (mc_clock_level_t)level),
+                                    events->context[level]);
+    }
+}// end rollover_dispatch
+
+static void rollover_check(mc_clock_t *_clock, const clock_datetime_t *old, int32_t old_timestamp)
+{
+    if (_clock->datetime.flags & CLOCK_FLAG_EVENTS)
+        rollover_dispatch(_clock, old, old_timestamp);
+}// end rollover_check
+
+// keep datetime before an update, then dispatch the rollovers it caused
+#define ROLLOVER_BEGIN(c) const clock_datetime_t _rollover_old = (c)->datetime; const int32_t _rollover_timestamp = (c)->timestamp
+#define ROLLOVER_END(c) rollover_check((c), &_rollover_old, _rollover_timestamp)
+
 
 
 
@@ -151,18 +443,24 @@ static int32_t Mc_Clock_Human_Date_To_Timestamp(const clock_datetime_t *t)
 
 void *Mc_Clock_New(void)
 {
-    clock_t *p = malloc(sizeof(clock_t));
+    STAT_CALL(MC_CLOCK_STAT_NEW);
+    clock_object_t *o = malloc(sizeof(clock_object_t));
+    mc_clock_t *p = &(o->clock);
+    o->events = NULL;
     p->timestamp = DEFAULT_TIMESTAMP;
     p->datetime = Mc_Clock_Timestamp_To_Human_Date(DEFAULT_TIMESTAMP);
+    p->datetime.flags = CLOCK_FLAG_OBJECT;
     return p;
 }// end Mc_Clock_New
 
 void *Mc_Clock_Clone(void *clock)
 {
-    clock_t *_clock = clock;
-    clock_t *p = Mc_Clock_New();
+    STAT_CALL(MC_CLOCK_STAT_CLONE);
+    mc_clock_t *_clock = clock;
+    mc_clock_t *p = Mc_Clock_New();
 
-    p->datetime = _clock->datetime;
+    // rollover callbacks are not copied
+    set_datetime(p, _clock->datetime);
     p->timestamp = _clock->timestamp;
 
     return (void *)p;
@@ -170,7 +468,10 @@ void *Mc_Clock_Clone(void *clock)
 
 void Mc_Clock_Destroy(void *clock)
 {
-    free((clock_t *)clock);
+    STAT_CALL(MC_CLOCK_STAT_DESTROY);
+    clock_object_t *o = clock;
+    free(o->events);
+    free(o);
 }// end Mc_Clock_Destroy
 
 
@@ -180,7 +481,9 @@ void Mc_Clock_Destroy(void *clock)
 
 void Mc_Clock_Clear_Time(void *clock)
 {
-    clock_t *_clock = clock;
+    STAT_CALL(MC_CLOCK_STAT_CLEAR_TIME);
+    mc_clock_t *_clock = clock;
+    ROLLOVER_BEGIN(_clock);
 
     _clock->datetime.hour = 0;
     _clock->datetime.minute = 0;
@@ -188,16 +491,20 @@ void Mc_Clock_Clear_Time(void *clock)
 
     // update timestamp
     _clock->timestamp = Mc_Clock_Human_Date_To_Timestamp(&(_clock->datetime));
+    ROLLOVER_END(_clock);
 }// end Mc_Clock_Clear_Time
 
 void Mc_Clock_Clear_DateTime(void *clock)
 {
-    clock_t *_clock = clock;
+    STAT_CALL(MC_CLOCK_STAT_CLEAR_DATETIME);
+    mc_clock_t *_clock = clock;
+    ROLLOVER_BEGIN(_clock);
 
     _clock->timestamp = DEFAULT_TIMESTAMP;
 
     // update datetime
-    _clock->datetime = Mc_Clock_Timestamp_To_Human_Date(_clock->timestamp);
+    set_datetime(_clock, Mc_Clock_Timestamp_To_Human_Date(_clock->timestamp));
+    ROLLOVER_END(_clock);
 }// end Mc_Clock_Clear_DateTime
 
 
@@ -207,57 +514,83 @@ void Mc_Clock_Clear_DateTime(void *clock)
 
 void Mc_Clock_Set_Timestamp(void *clock, int32_t timestamp)
 {
-    clock_t *_clock = clock;
+    STAT_CALL(MC_CLOCK_STAT_SET_TIMESTAMP);
+    mc_clock_t *_clock = clock;
+    ROLLOVER_BEGIN(_clock);
     _clock->timestamp = timestamp;
-    _clock->datetime = Mc_Clock_Timestamp_To_Human_Date(timestamp);
+    set_datetime(_clock, Mc_Clock_Timestamp_To_Human_Date(timestamp));
+    ROLLOVER_END(_clock);
 }// end Mc_Clock_Set_Timestamp
 
 void Mc_Clock_Set_Second(void *clock, uint8_t second)
 {
+    STAT_CALL(MC_CLOCK_STAT_SET_SECOND);
     if (second > 59)
         return;
 
-    clock_t *_clock = clock;
+    mc_clock_t *_clock = clock;
+    ROLLOVER_BEGIN(_clock);
     _clock->datetime.second = second;
     // update timestamp
     _clock->timestamp = Mc_Clock_Human_Date_To_Timestamp(&(_clock->datetime));
+    ROLLOVER_END(_clock);
 }// end Mc_Clock_Set_Second
 
 void Mc_Clock_Set_Minute(void *clock, uint8_t minute)
 {
+    STAT_CALL(MC_CLOCK_STAT_SET_MINUTE);
     if (minute > 59)
         return;
 
-    clock_t *_clock = clock;
+    mc_clock_t *_clock = clock;
+    ROLLOVER_BEGIN(_clock);
     _clock->datetime.minute = minute;
     // update timestamp
     _clock->timestamp = Mc_Clock_Human_Date_To_Timestamp(&(_clock->datetime));
+    ROLLOVER_END(_clock);
 }// end Mc_Clock_Set_Minute
 
 void Mc_Clock_Set_Hour(void *clock, uint8_t hour)
 {
+    STAT_CALL(MC_CLOCK_STAT_SET_HOUR);
     if (hour > 23)
         return;
 
-    clock_t *_clock = clock;
+    mc_clock_t *_clock = clock;
+    ROLLOVER_BEGIN(_clock);
     _clock->datetime.hour = hour;
     // update timestamp
     _clock->timestamp = Mc_Clock_Human_Date_To_Timestamp(&(_clock->datetime));
+    ROLLOVER_END(_clock);
 }// end Mc_Clock_Set_Hour
 
 void Mc_Clock_Set_Time(void *clock, uint8_t hour, uint8_t minute, uint8_t second)
 {
-    Mc_Clock_Set_Hour(clock, hour);
-    Mc_Clock_Set_Minute(clock, minute);
-    Mc_Clock_Set_Second(clock, second);
+    STAT_CALL(MC_CLOCK_STAT_SET_TIME);
+    mc_clock_t *_clock = clock;
+    ROLLOVER_BEGIN(_clock);
+
+    // invalid values are ignored, as by Mc_Clock_Set_Hour/Minute/Second
+    if (hour <= 23)
+        _clock->datetime.hour = hour;
+    if (minute <= 59)
+        _clock->datetime.minute = minute;
+    if (second <= 59)
+        _clock->datetime.second = second;
+
+    // update timestamp once
+    _clock->timestamp = Mc_Clock_Human_Date_To_Timestamp(&(_clock->datetime));
+    ROLLOVER_END(_clock);
 }// end Mc_Clock_Set_Time
 
 void Mc_Clock_Set_Day(void *clock, uint8_t day)
 {
+    STAT_CALL(MC_CLOCK_STAT_SET_DAY);
     if (day == 0 || day > 31)
         return;
 
-    clock_t *_clock = clock;
+    mc_clock_t *_clock = clock;
+    ROLLOVER_BEGIN(_clock);
 
     // verify if day is in month
     uint8_t dim = days_in_month(_clock->datetime.month, _clock->datetime.year);
@@ -267,14 +600,17 @@ void Mc_Clock_Set_Day(void *clock, uint8_t day)
     _clock->datetime.day = day;
     // update timestamp
     _clock->timestamp = Mc_Clock_Human_Date_To_Timestamp(&(_clock->datetime));
+    ROLLOVER_END(_clock);
 }// end Mc_Clock_Set_Day
 
 void Mc_Clock_Set_Month(void *clock, uint8_t month)
 {
+    STAT_CALL(MC_CLOCK_STAT_SET_MONTH);
     if (month > 12 || month == 0)
         return;
 
-    clock_t *_clock = clock;
+    mc_clock_t *_clock = clock;
+    ROLLOVER_BEGIN(_clock);
     _clock->datetime.month = month;
 
     // verify day in month
@@ -286,14 +622,17 @@ void Mc_Clock_Set_Month(void *clock, uint8_t month)
 
     // update timestamp
     _clock->timestamp = Mc_Clock_Human_Date_To_Timestamp(&(_clock->datetime));
+    ROLLOVER_END(_clock);
 }// end Mc_Clock_Set_Month
 
 void Mc_Clock_Set_Year(void *clock, uint16_t year)
 {
+    STAT_CALL(MC_CLOCK_STAT_SET_YEAR);
     if(year > 2036 || year < 1901)
         return;
 
-    clock_t *_clock = clock;
+    mc_clock_t *_clock = clock;
+    ROLLOVER_BEGIN(_clock);
     _clock->datetime.year = year;
 
     // verify day in month
@@ -305,13 +644,34 @@ void Mc_Clock_Set_Year(void *clock, uint16_t year)
 
     // update timestamp
     _clock->timestamp = Mc_Clock_Human_Date_To_Timestamp(&(_clock->datetime));
+    ROLLOVER_END(_clock);
 }// end Mc_Clock_Set_Year
 
 void Mc_Clock_Set_Date(void *clock, uint16_t year, uint8_t month, uint8_t day)
 {
-    Mc_Clock_Set_Year(clock, year);
-    Mc_Clock_Set_Month(clock, month);
-    Mc_Clock_Set_Day(clock, day);
+    STAT_CALL(MC_CLOCK_STAT_SET_DATE);
+    mc_clock_t *_clock = clock;
+    ROLLOVER_BEGIN(_clock);
+
+    // same steps as Mc_Clock_Set_Year, Mc_Clock_Set_Month and Mc_Clock_Set_Day
+    if (year <= 2036 && year >= 1901)
+    {
+        _clock->datetime.year = year;
+        clamp_day(&(_clock->datetime));
+    }
+
+    if (month <= 12 && month != 0)
+    {
+        _clock->datetime.month = month;
+        clamp_day(&(_clock->datetime));
+    }
+
+    if (day != 0 && day <= days_in_month(_clock->datetime.month, _clock->datetime.year))
+        _clock->datetime.day = day;
+
+    // update timestamp once
+    _clock->timestamp = Mc_Clock_Human_Date_To_Timestamp(&(_clock->datetime));
+    ROLLOVER_END(_clock);
 }// end Mc_Clock_Set_Date
 
 
@@ -321,38 +681,45 @@ void Mc_Clock_Set_Date(void *clock, uint16_t year, uint8_t month, uint8_t day)
 
 int32_t Mc_Clock_Get_Timestamp(void *clock)
 {
-    clock_t *_clock = clock;
+    STAT_CALL(MC_CLOCK_STAT_GET_TIMESTAMP);
+    mc_clock_t *_clock = clock;
     return _clock->timestamp;
 }// end Mc_Clock_Get_Timestamp
 
 uint8_t Mc_Clock_Get_Second(void *clock)
 {
-    return ((clock_t *)clock)->datetime.second;
+    STAT_CALL(MC_CLOCK_STAT_GET_SECOND);
+    return ((mc_clock_t *)clock)->datetime.second;
 }// end Mc_Clock_Get_Second
 
 uint8_t Mc_Clock_Get_Minute(void *clock)
 {
-    return ((clock_t *)clock)->datetime.minute;
+    STAT_CALL(MC_CLOCK_STAT_GET_MINUTE);
+    return ((mc_clock_t *)clock)->datetime.minute;
 }// end Mc_Clock_Get_Minute
 
 uint8_t Mc_Clock_Get_Hour(void *clock)
 {
-    return ((clock_t *)clock)->datetime.hour;
+    STAT_CALL(MC_CLOCK_STAT_GET_HOUR);
+    return ((mc_clock_t *)clock)->datetime.hour;
 }// end Mc_Clock_Get_Hour
 
 uint8_t Mc_Clock_Get_Day(void *clock)
 {
-    return ((clock_t *)clock)->datetime.day;
+    STAT_CALL(MC_CLOCK_STAT_GET_DAY);
+    return ((mc_clock_t *)clock)->datetime.day;
 }// end Mc_Clock_Get_Day
 
 uint8_t Mc_Clock_Get_Month(void *clock)
 {
-    return ((clock_t *)clock)->datetime.month;
+    STAT_CALL(MC_CLOCK_STAT_GET_MONTH);
+    return ((mc_clock_t *)clock)->datetime.month;
 }// end Mc_Clock_Get_Month
 
 uint16_t Mc_Clock_Get_Year(void *clock)
 {
-    return ((clock_t *)clock)->datetime.year;
+    STAT_CALL(MC_CLOCK_STAT_GET_YEAR);
+    return ((mc_clock_t *)clock)->datetime.year;
 }// end Mc_Clock_Get_Year
 
 
@@ -362,23 +729,31 @@ uint16_t Mc_Clock_Get_Year(void *clock)
 
 void Mc_Clock_Increment_Timestamp(void *clock)
 {
-    clock_t *_clock = clock;
+    STAT_CALL(MC_CLOCK_STAT_INCREMENT_TIMESTAMP);
+    mc_clock_t *_clock = clock;
+    ROLLOVER_BEGIN(_clock);
 
     (_clock->timestamp)++;
-    _clock->datetime = Mc_Clock_Timestamp_To_Human_Date(_clock->timestamp);
+    set_datetime(_clock, Mc_Clock_Timestamp_To_Human_Date(_clock->timestamp));
+    ROLLOVER_END(_clock);
 }// end Mc_Clock_Increment_Timestamp
 
 void Mc_Clock_Increment_Timestamp_Value(void * clock, int32_t value)
 {
-    clock_t *_clock = clock;
+    STAT_CALL(MC_CLOCK_STAT_INCREMENT_TIMESTAMP_VALUE);
+    mc_clock_t *_clock = clock;
+    ROLLOVER_BEGIN(_clock);
 
     (_clock->timestamp) += value;
-    _clock->datetime = Mc_Clock_Timestamp_To_Human_Date(_clock->timestamp);
+    set_datetime(_clock, Mc_Clock_Timestamp_To_Human_Date(_clock->timestamp));
+    ROLLOVER_END(_clock);
 }// end Mc_Clock_Increment_Timestamp_Value
 
 void Mc_Clock_Increment_Second(void *clock)
 {
-    clock_t *_clock = clock;
+    STAT_CALL(MC_CLOCK_STAT_INCREMENT_SECOND);
+    mc_clock_t *_clock = clock;
+    ROLLOVER_BEGIN(_clock);
 
     if (_clock->datetime.second == 59)
     {
@@ -391,11 +766,14 @@ void Mc_Clock_Increment_Second(void *clock)
 
     // update timestamp
     _clock->timestamp = Mc_Clock_Human_Date_To_Timestamp(&(_clock->datetime));
+    ROLLOVER_END(_clock);
 }// end Mc_Clock_Increment_Second
 
 void Mc_Clock_Increment_Minute(void *clock)
 {
-    clock_t *_clock = clock;
+    STAT_CALL(MC_CLOCK_STAT_INCREMENT_MINUTE);
+    mc_clock_t *_clock = clock;
+    ROLLOVER_BEGIN(_clock);
 
     if (_clock->datetime.minute == 59)
     {
@@ -408,11 +786,14 @@ void Mc_Clock_Increment_Minute(void *clock)
 
     // update timestamp
     _clock->timestamp = Mc_Clock_Human_Date_To_Timestamp(&(_clock->datetime));
+    ROLLOVER_END(_clock);
 }// end Mc_Clock_Increment_Minute
 
 void Mc_Clock_Increment_Hour(void *clock)
 {
-    clock_t *_clock = clock;
+    STAT_CALL(MC_CLOCK_STAT_INCREMENT_HOUR);
+    mc_clock_t *_clock = clock;
+    ROLLOVER_BEGIN(_clock);
 
     if (_clock->datetime.hour == 23)
     {
@@ -425,11 +806,14 @@ void Mc_Clock_Increment_Hour(void *clock)
 
     // update timestamp
     _clock->timestamp = Mc_Clock_Human_Date_To_Timestamp(&(_clock->datetime));
+    ROLLOVER_END(_clock);
 }// end Mc_Clock_Increment_Hour
 
 void Mc_Clock_Increment_Day(void *clock)
 {
-    clock_t *_clock = clock;
+    STAT_CALL(MC_CLOCK_STAT_INCREMENT_DAY);
+    mc_clock_t *_clock = clock;
+    ROLLOVER_BEGIN(_clock);
 
     // get days in the month
     uint8_t dim = days_in_month(_clock->datetime.month, _clock->datetime.year);
@@ -445,11 +829,14 @@ void Mc_Clock_Increment_Day(void *clock)
 
     // update timestamp
     _clock->timestamp = Mc_Clock_Human_Date_To_Timestamp(&(_clock->datetime));
+    ROLLOVER_END(_clock);
 }// end Mc_Clock_Increment_Day
 
 void Mc_Clock_Increment_Month(void *clock)
 {
-    clock_t *_clock = clock;
+    STAT_CALL(MC_CLOCK_STAT_INCREMENT_MONTH);
+    mc_clock_t *_clock = clock;
+    ROLLOVER_BEGIN(_clock);
 
     if (_clock->datetime.month == 12)
     {
@@ -470,11 +857,14 @@ void Mc_Clock_Increment_Month(void *clock)
 
     // update timestamp
     _clock->timestamp = Mc_Clock_Human_Date_To_Timestamp(&(_clock->datetime));
+    ROLLOVER_END(_clock);
 }// end Mc_Clock_Increment_Month
 
 void Mc_Clock_Increment_Year(void *clock)
 {
-    clock_t *_clock = clock;
+    STAT_CALL(MC_CLOCK_STAT_INCREMENT_YEAR);
+    mc_clock_t *_clock = clock;
+    ROLLOVER_BEGIN(_clock);
 
     (_clock->datetime.year)++;
 
@@ -488,6 +878,7 @@ void Mc_Clock_Increment_Year(void *clock)
 
     // update timestamp
     _clock->timestamp = Mc_Clock_Human_Date_To_Timestamp(&(_clock->datetime));
+    ROLLOVER_END(_clock);
 }// end Mc_Clock_Increment_Year
 
 
@@ -497,23 +888,31 @@ void Mc_Clock_Increment_Year(void *clock)
 
 void Mc_Clock_Decrement_Timestamp(void *clock)
 {
-    clock_t *_clock = clock;
+    STAT_CALL(MC_CLOCK_STAT_DECREMENT_TIMESTAMP);
+    mc_clock_t *_clock = clock;
+    ROLLOVER_BEGIN(_clock);
 
     (_clock->timestamp)--;
-    _clock->datetime = Mc_Clock_Timestamp_To_Human_Date(_clock->timestamp);
+    set_datetime(_clock, Mc_Clock_Timestamp_To_Human_Date(_clock->timestamp));
+    ROLLOVER_END(_clock);
 }// end Mc_Clock_Decrement_Timestamp
 
 void Mc_Clock_Decrement_Timestamp_Value(void * clock, int32_t value)
 {
-    clock_t *_clock = clock;
+    STAT_CALL(MC_CLOCK_STAT_DECREMENT_TIMESTAMP_VALUE);
+    mc_clock_t *_clock = clock;
+    ROLLOVER_BEGIN(_clock);
 
     (_clock->timestamp) -= value;
-    _clock->datetime = Mc_Clock_Timestamp_To_Human_Date(_clock->timestamp);
+    set_datetime(_clock, Mc_Clock_Timestamp_To_Human_Date(_clock->timestamp));
+    ROLLOVER_END(_clock);
 }// end Mc_Clock_Decrement_Timestamp_Value
 
 void Mc_Clock_Decrement_Second(void *clock)
 {
-    clock_t *_clock = clock;
+    STAT_CALL(MC_CLOCK_STAT_DECREMENT_SECOND);
+    mc_clock_t *_clock = clock;
+    ROLLOVER_BEGIN(_clock);
 
     if (_clock->datetime.second == 0)
     {
@@ -526,11 +925,14 @@ void Mc_Clock_Decrement_Second(void *clock)
 
     // update timestamp
     _clock->timestamp = Mc_Clock_Human_Date_To_Timestamp(&(_clock->datetime));
+    ROLLOVER_END(_clock);
 }// end Mc_Clock_Decrement_Second
 
 void Mc_Clock_Decrement_Minute(void *clock)
 {
-    clock_t *_clock = clock;
+    STAT_CALL(MC_CLOCK_STAT_DECREMENT_MINUTE);
+    mc_clock_t *_clock = clock;
+    ROLLOVER_BEGIN(_clock);
 
     if (_clock->datetime.minute == 0)
     {
@@ -543,11 +945,14 @@ void Mc_Clock_Decrement_Minute(void *clock)
 
     // update timestamp
     _clock->timestamp = Mc_Clock_Human_Date_To_Timestamp(&(_clock->datetime));
+    ROLLOVER_END(_clock);
 }// end Mc_Clock_Decrement_Minute
 
 void Mc_Clock_Decrement_Hour(void *clock)
 {
-    clock_t *_clock = clock;
+    STAT_CALL(MC_CLOCK_STAT_DECREMENT_HOUR);
+    mc_clock_t *_clock = clock;
+    ROLLOVER_BEGIN(_clock);
 
     if (_clock->datetime.hour == 0)
     {
@@ -560,11 +965,14 @@ void Mc_Clock_Decrement_Hour(void *clock)
 
     // update timestamp
     _clock->timestamp = Mc_Clock_Human_Date_To_Timestamp(&(_clock->datetime));
+    ROLLOVER_END(_clock);
 }// end Mc_Clock_Decrement_Hour
 
 void Mc_Clock_Decrement_Day(void *clock)
 {
-    clock_t *_clock = clock;
+    STAT_CALL(MC_CLOCK_STAT_DECREMENT_DAY);
+    mc_clock_t *_clock = clock;
+    ROLLOVER_BEGIN(_clock);
 
     if (_clock->datetime.day == 1)
     {
@@ -579,11 +987,14 @@ void Mc_Clock_Decrement_Day(void *clock)
 
     // update timestamp
     _clock->timestamp = Mc_Clock_Human_Date_To_Timestamp(&(_clock->datetime));
+    ROLLOVER_END(_clock);
 }// end Mc_Clock_Decrement_Day
 
 void Mc_Clock_Decrement_Month(void *clock)
 {
-    clock_t *_clock = clock;
+    STAT_CALL(MC_CLOCK_STAT_DECREMENT_MONTH);
+    mc_clock_t *_clock = clock;
+    ROLLOVER_BEGIN(_clock);
 
     if (_clock->datetime.month == 1)
     {
@@ -603,11 +1014,14 @@ void Mc_Clock_Decrement_Month(void *clock)
 
     // update timestamp
     _clock->timestamp = Mc_Clock_Human_Date_To_Timestamp(&(_clock->datetime));
+    ROLLOVER_END(_clock);
 }// end Mc_Clock_Decrement_Month
 
 void Mc_Clock_Decrement_Year(void *clock)
 {
-    clock_t *_clock = clock;
+    STAT_CALL(MC_CLOCK_STAT_DECREMENT_YEAR);
+    mc_clock_t *_clock = clock;
+    ROLLOVER_BEGIN(_clock);
 
     if (_clock->datetime.year == 1970)
     {
@@ -627,4 +1041,1170 @@ void Mc_Clock_Decrement_Year(void *clock)
 
     // update timestamp
     _clock->timestamp = Mc_Clock_Human_Date_To_Timestamp(&(_clock->datetime));
+    ROLLOVER_END(_clock);
 }// end Mc_Clock_Decrement_Year
+
+
+
+
+// ==================   Rollover Events   ================ //
+
+int Mc_Clock_On_Rollover(void *clock, mc_clock_level_t level, mc_clock_rollover_callback_t callback, void *context, uint8_t replay)
+{
+    STAT_CALL(MC_CLOCK_STAT_ON_ROLLOVER);
+    mc_clock_t *_clock = clock;
+    clock_object_t *o = clock;
+
+    if (!(_clock->datetime.flags & CLOCK_FLAG_OBJECT) || (unsigned)level >= MC_CLOCK_LEVEL_COUNT)
+        return -1;
+
+    if (o->events == NULL)
+    {
+        if (callback == NULL)
+            return 0;
+
+        o->events = calloc(1, sizeof(clock_events_t));
+        if (o->events == NULL)
+            return -1;
+    }
+
+    o->events->callback[level] = callback;
+    o->events->context[level] = context;
+    if (replay)
+        o->events->replay |= (uint8_t)(1 << level);
+    else
+        o->events->replay &= (uint8_t)~(1 << level);
+
+    // dispatch only while a callback is registered
+    _clock->datetime.flags &= (uint8_t)~CLOCK_FLAG_EVENTS;
+    for (int l = 0; l < MC_CLOCK_LEVEL_COUNT; l++)
+    {
+        if (o->events->callback[l] != NULL)
+            _clock->datetime.flags |= CLOCK_FLAG_EVENTS;
+    }
+
+    return 0;
+}// end Mc_Clock_On_Rollover
+
+
+
+// ==================   Conversion   ================ //
+
+int32_t Mc_Clock_Date_To_Timestamp(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second)
+{
+    STAT_CALL(MC_CLOCK_STAT_DATE_TO_TIMESTAMP);
+
+    if (month == 0 || month > 12 || day == 0 || day > days_in_month(month, year))
+        return INT32_MIN;
+
+    clock_datetime_t t = {year, month, day, hour, minute, second, 0};
+    return Mc_Clock_Human_Date_To_Timestamp(&t);
+}// end Mc_Clock_Date_To_Timestamp
+
+int32_t Mc_Clock_Date_To_Days(uint16_t year, uint8_t month, uint8_t day)
+{
+    STAT_CALL(MC_CLOCK_STAT_DATE_TO_DAYS);
+
+    // years starting on march: leap day is the last day of the year
+    int32_t y = (int32_t)year - (month <= 2);
+    int32_t era = y / 400;                                              // year >= 1: no negative division
+    int32_t yoe = y - era * 400;                                        // [0, 399]
+    int32_t doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1; // [0, 365]
+    int32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;                // [0, 146096]
+
+    return era * 146097 + doe - 719468;
+}// end Mc_Clock_Date_To_Days
+
+int32_t Mc_Clock_Timestamp_To_Days(int64_t timestamp)
+{
+    STAT_CALL(MC_CLOCK_STAT_TIMESTAMP_TO_DAYS);
+    return timestamp_days(timestamp);
+}// end Mc_Clock_Timestamp_To_Days
+
+uint8_t Mc_Clock_Is_Leap_Year(uint16_t year)
+{
+    STAT_CALL(MC_CLOCK_STAT_IS_LEAP_YEAR);
+    return is_leap_year(year);
+}// end Mc_Clock_Is_Leap_Year
+
+uint8_t Mc_Clock_Days_In_Month(uint8_t month, uint16_t year)
+{
+    STAT_CALL(MC_CLOCK_STAT_DAYS_IN_MONTH);
+    if (month == 0 || month > 12)
+        return 0;
+
+    return days_in_month(month, year);
+}// end Mc_Clock_Days_In_Month
+
+uint8_t Mc_Clock_Days_To_Weekday(int32_t days)
+{
+    STAT_CALL(MC_CLOCK_STAT_DAYS_TO_WEEKDAY);
+    return days_weekday(days);
+}// end Mc_Clock_Days_To_Weekday
+
+void Mc_Clock_Split_Time_Of_Day(uint32_t seconds, uint8_t *hour, uint8_t *minute, uint8_t *second)
+{
+    STAT_CALL(MC_CLOCK_STAT_SPLIT_TIME_OF_DAY);
+    split_time_of_day(seconds, hour, minute, second);
+}// end Mc_Clock_Split_Time_Of_Day
+
+
+
+// ==================   Comparison and Sorting   ================ //
+
+// LSD radix: 3 passes of 11 bits over the timestamp with the sign bit flipped
+#define SORT_BITS       11
+#define SORT_BUCKETS    (1 << SORT_BITS)
+#define SORT_PASSES     3
+// below this count: insertion sort, no allocation
+#define SORT_SMALL      64
+
+typedef struct
+{
+    uint32_t key;
+    void *clock;
+} sort_item_t;
+
+static uint32_t sort_key(const void *clock)
+{
+    return (uint32_t)((const mc_clock_t *)clock)->timestamp ^ 0x80000000u;
+}// end sort_key
+
+static uint32_t sort_digit(uint32_t key, int pass)
+{
+    return (key >> (pass * SORT_BITS)) & (SORT_BUCKETS - 1);
+}// end sort_digit
+
+static void sort_insertion(void **clocks, size_t count)
+{
+    for (size_t i = 1; i < count; i++)
+    {
+        void *clock = clocks[i];
+        int32_t timestamp = ((mc_clock_t *)clock)->timestamp;
+        size_t j = i;
+
+        while (j > 0 && ((mc_clock_t *)clocks[j - 1])->timestamp > timestamp)
+        {
+            clocks[j] = clocks[j - 1];
+            j--;
+        }
+        clocks[j] = clock;
+    }
+}// end sort_insertion
+
+// turn bucket counts into start offsets. 1 if every item is in the same bucket (pass can be skipped)
+static uint8_t sort_offsets(size_t *buckets, size_t count)
+{
+    size_t sum = 0;
+
+    for (int b = 0; b < SORT_BUCKETS; b++)
+    {
+        size_t n = buckets[b];
+        if (n == count)
+            return 1;
+
+        buckets[b] = sum;
+        sum += n;
+    }
+
+    return 0;
+}// end sort_offsets
+
+static void sort_scatter(const sort_item_t *src, sort_item_t *dst, size_t begin, size_t end, int pass, size_t *offsets)
+{
+    for (size_t i = begin; i < end; i++)
+        dst[offsets[sort_digit(src[i].key, pass)]++] = src[i];
+}// end sort_scatter
+
+int Mc_Clock_Compare(void *a, void *b)
+{
+    STAT_CALL(MC_CLOCK_STAT_COMPARE);
+    int32_t ta = ((mc_clock_t *)a)->timestamp;
+    int32_t tb = ((mc_clock_t *)b)->timestamp;
+
+    return (ta > tb) - (ta < tb);
+}// end Mc_Clock_Compare
+
+int Mc_Clock_Sort(void **clocks, size_t count)
+{
+    STAT_CALL(MC_CLOCK_STAT_SORT);
+
+    if (count < SORT_SMALL)
+    {
+        sort_insertion(clocks, count);
+        return 0;
+    }
+
+    sort_item_t *items = malloc(2 * count * sizeof(sort_item_t));
+    size_t (*buckets)[SORT_BUCKETS] = calloc(SORT_PASSES, sizeof(*buckets));
+    if (items == NULL || buckets == NULL)
+    {
+        free(items);
+        free(buckets);
+        return -1;
+    }
+
+    // read every timestamp once, counting the digits of all passes
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t key = sort_key(clocks[i]);
+        items[i].key = key;
+        items[i].clock = clocks[i];
+
+        for (int pass = 0; pass < SORT_PASSES; pass++)
+            buckets[pass][sort_digit(key, pass)]++;
+    }
+
+    sort_item_t *src = items;
+    sort_item_t *dst = items + count;
+    for (int pass = 0; pass < SORT_PASSES; pass++)
+    {
+        if (sort_offsets(buckets[pass], count))
+            continue;
+
+        sort_scatter(src, dst, 0, count, pass, buckets[pass]);
+
+        sort_item_t *tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+
+    for (size_t i = 0; i < count; i++)
+        clocks[i] = src[i].clock;
+
+    free(items);
+    free(buckets);
+    return 0;
+}// end Mc_Clock_Sort
+
+#ifdef MC_CLOCK_THREADS
+
+typedef enum
+{
+    SORT_PHASE_LOAD = 0,    // read keys of the chunk
+    SORT_PHASE_COUNT,       // count digits of the chunk
+    SORT_PHASE_SCATTER,     // move the chunk to its buckets
+    SORT_PHASE_STORE        // write clocks of the chunk back
+} sort_phase_t;
+
+typedef struct
+{
+    sort_phase_t phase;
+    int pass;
+    void **clocks;
+    const sort_item_t *src;
+    sort_item_t *dst;
+    size_t begin;
+    size_t end;
+    size_t buckets[SORT_BUCKETS];
+} sort_task_t;
+
+static void *sort_worker(void *arg)
+{
+    sort_task_t *task = arg;
+
+    switch (task->phase)
+    {
+    case SORT_PHASE_LOAD:
+        for (size_t i = task->begin; i < task->end; i++)
+        {
+            task->dst[i].key = sort_key(task->clocks[i]);
+            task->dst[i].clock = task->clocks[i];
+        }
+        break;
+
+    case SORT_PHASE_COUNT:
+        memset(task->buckets, 0, sizeof(task->buckets));
+        for (size_t i = task->begin; i < task->end; i++)
+            task->buckets[sort_digit(task->src[i].key, task->pass)]++;
+        break;
+
+    case SORT_PHASE_SCATTER:
+        sort_scatter(task->src, task->dst, task->begin, task->end, task->pass, task->buckets);
+        break;
+
+    default:
+        for (size_t i = task->begin; i < task->end; i++)
+            task->clocks[i] = task->src[i].clock;
+        break;
+    }
+
+    return NULL;
+}// end sort_worker
+
+// run one phase on every task, the calling thread takes task 0
+static void sort_run(sort_task_t *tasks, pthread_t *ids, unsigned threads, sort_phase_t phase)
+{
+    for (unsigned t = 0; t < threads; t++)
+        tasks[t].phase = phase;
+
+    for (unsigned t = 1; t < threads; t++)
+    {
+        if (pthread_create(&ids[t], NULL, sort_worker, &tasks[t]) != 0)
+        {
+            // no thread: run it here
+            sort_worker(&tasks[t]);
+            ids[t] = ids[0];
+        }
+    }
+
+    sort_worker(&tasks[0]);
+
+    for (unsigned t = 1; t < threads; t++)
+    {
+        if (!pthread_equal(ids[t], ids[0]))
+            pthread_join(ids[t], NULL);
+    }
+}// end sort_run
+
+int Mc_Clock_Sort_Parallel(void **clocks, size_t count, unsigned threads)
+{
+    STAT_CALL(MC_CLOCK_STAT_SORT_PARALLEL);
+
+    if (threads <= 1 || count < (size_t)threads * SORT_BUCKETS)
+        return Mc_Clock_Sort(clocks, count);
+
+    sort_item_t *items = malloc(2 * count * sizeof(sort_item_t));
+    sort_task_t *tasks = malloc(threads * sizeof(sort_task_t));
+    pthread_t *ids = malloc(threads * sizeof(pthread_t));
+    if (items == NULL || tasks == NULL || ids == NULL)
+    {
+        free(items);
+        free(tasks);
+        free(ids);
+        return -1;
+    }
+
+    ids[0] = pthread_self();
+    for (unsigned t = 0; t < threads; t++)
+    {
+        tasks[t].clocks = clocks;
+        tasks[t].begin = count * t / threads;
+        tasks[t].end = count * (t + 1) / threads;
+        tasks[t].dst = items;
+    }
+
+    sort_run(tasks, ids, threads, SORT_PHASE_LOAD);
+
+    sort_item_t *src = items;
+    sort_item_t *dst = items + count;
+    for (int pass = 0; pass < SORT_PASSES; pass++)
+    {
+        for (unsigned t = 0; t < threads; t++)
+        {
+            tasks[t].pass = pass;
+            tasks[t].src = src;
+            tasks[t].dst = dst;
+        }
+
+        sort_run(tasks, ids, threads, SORT_PHASE_COUNT);
+
+        // every key in the same bucket: nothing moves
+        uint8_t skip = 0;
+        for (int b = 0; b < SORT_BUCKETS && !skip; b++)
+        {
+            size_t total = 0;
+            for (unsigned t = 0; t < threads; t++)
+                total += tasks[t].buckets[b];
+            skip = (total == count);
+        }
+        if (skip)
+            continue;
+
+        // bucket by bucket, chunks in order: stable
+        size_t sum = 0;
+        for (int b = 0; b < SORT_BUCKETS; b++)
+        {
+            for (unsigned t = 0; t < threads; t++)
+            {
+                size_t n = tasks[t].buckets[b];
+                tasks[t].buckets[b] = sum;
+                sum += n;
+            }
+        }
+
+        sort_run(tasks, ids, threads, SORT_PHASE_SCATTER);
+
+        sort_item_t *tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+
+    for (unsigned t = 0; t < threads; t++)
+        tasks[t].src = src;
+    sort_run(tasks, ids, threads, SORT_PHASE_STORE);
+
+    free(items);
+    free(tasks);
+    free(ids);
+    return 0;
+}// end Mc_Clock_Sort_Parallel
+
+#endif /* MC_CLOCK_THREADS */
+
+
+
+// ==================   System Time   ================ //
+
+#ifdef MC_CLOCK_SYSTEM
+
+#ifdef CLOCK_REALTIME_COARSE
+#define SYSTEM_REALTIME_COARSE CLOCK_REALTIME_COARSE
+#else
+#define SYSTEM_REALTIME_COARSE CLOCK_REALTIME
+#endif
+
+#ifdef CLOCK_MONOTONIC_COARSE
+#define SYSTEM_MONOTONIC CLOCK_MONOTONIC_COARSE
+#else
+#define SYSTEM_MONOTONIC CLOCK_MONOTONIC
+#endif
+
+// source and offset are shared by every thread that syncs: the offset is stored before the source is published
+#if defined(__GNUC__)
+#define SYSTEM_LOAD(v, order)       __atomic_load_n(&(v), (order))
+#define SYSTEM_STORE(v, x, order)   __atomic_store_n(&(v), (x), (order))
+#define SYSTEM_ACQUIRE              __ATOMIC_ACQUIRE
+#define SYSTEM_RELEASE              __ATOMIC_RELEASE
+#define SYSTEM_RELAXED              __ATOMIC_RELAXED
+#else
+#define SYSTEM_LOAD(v, order)       (v)
+#define SYSTEM_STORE(v, x, order)   ((v) = (x))
+#endif
+
+static mc_clock_source_t system_source = MC_CLOCK_SOURCE_REALTIME_COARSE;
+
+// wall time minus monotonic time (ns), latched by Mc_Clock_Set_System_Source
+static int64_t system_monotonic_offset;
+
+static int64_t system_read_ns(clockid_t id)
+{
+    struct timespec ts;
+    clock_gettime(id, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}// end system_read_ns
+
+static void system_latch_monotonic(void)
+{
+    int64_t mono = system_read_ns(SYSTEM_MONOTONIC);
+    SYSTEM_STORE(system_monotonic_offset, system_read_ns(CLOCK_REALTIME) - mono, SYSTEM_RELAXED);
+}// end system_latch_monotonic
+
+static int32_t system_now(void)
+{
+    int64_t seconds;
+
+    switch (SYSTEM_LOAD(system_source, SYSTEM_ACQUIRE))
+    {
+    case MC_CLOCK_SOURCE_MONOTONIC:
+    {
+        // latched before the source was published
+        int64_t ns = system_read_ns(SYSTEM_MONOTONIC) + SYSTEM_LOAD(system_monotonic_offset, SYSTEM_RELAXED);
+        seconds = ns / 1000000000LL;
+        if (ns % 1000000000LL < 0)
+            seconds -= 1;
+        break;
+    }
+    case MC_CLOCK_SOURCE_REALTIME:
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        seconds = ts.tv_sec;
+        break;
+    }
+    default:
+    {
+        struct timespec ts;
+        clock_gettime(SYSTEM_REALTIME_COARSE, &ts);
+        seconds = ts.tv_sec;
+        break;
+    }
+    }
+
+    if (seconds > INT32_MAX)
+        seconds = INT32_MAX;
+    else if (seconds < INT32_MIN)
+        seconds = INT32_MIN;
+
+    return (int32_t)seconds;
+}// end system_now
+
+static void Mc_Clock_Advance_To(mc_clock_t *_clock, int32_t timestamp)
+{
+    // seconds elapsed in the current day, after moving to the new timestamp
+    int64_t seconds = (int64_t)_clock->datetime.hour * 3600 + (int64_t)_clock->datetime.minute * 60 + _clock->datetime.second;
+    seconds += (int64_t)timestamp - _clock->timestamp;
+
+    _clock->timestamp = timestamp;
+
+    // day changed: full conversion
+    if (seconds < 0 || seconds >= 86400LL)
+    {
+        set_datetime(_clock, Mc_Clock_Timestamp_To_Human_Date(timestamp));
+        return;
+    }
+
+    // same day: only split time of day again
+    split_time_of_day((uint32_t)seconds, &_clock->datetime.hour, &_clock->datetime.minute, &_clock->datetime.second);
+}// end Mc_Clock_Advance_To
+
+void Mc_Clock_Set_System_Source(mc_clock_source_t source)
+{
+    STAT_CALL(MC_CLOCK_STAT_SET_SYSTEM_SOURCE);
+
+    if (source == MC_CLOCK_SOURCE_MONOTONIC)
+        system_latch_monotonic();
+
+    SYSTEM_STORE(system_source, source, SYSTEM_RELEASE);
+}// end Mc_Clock_Set_System_Source
+
+int32_t Mc_Clock_Sync_System(void *clock)
+{
+    STAT_CALL(MC_CLOCK_STAT_SYNC_SYSTEM);
+    mc_clock_t *_clock = clock;
+    int32_t now = system_now();
+
+    // same second: datetime is already up to date
+    ROLLOVER_BEGIN(_clock);
+    if (now != _clock->timestamp)
+        Mc_Clock_Advance_To(_clock, now);
+
+    ROLLOVER_END(_clock);
+    return now;
+}// end Mc_Clock_Sync_System
+
+#endif /* MC_CLOCK_SYSTEM */
+
+
+
+
+// ==================   Snapshot   ================ //
+
+static const uint8_t snapshot_magic[4] = {'M', 'C', 'C', 'S'};
+
+static uint8_t host_is_little_endian(void)
+{
+    const uint16_t one = 1;
+    return *(const uint8_t *)&one;
+}// end host_is_little_endian
+
+static void put_le16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}// end put_le16
+
+static void put_le32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}// end put_le32
+
+static uint16_t get_le16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}// end get_le16
+
+static uint32_t get_le32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}// end get_le32
+
+// Fletcher style checksum over little-endian 32 bit words (sums modulo 2^32)
+static void snapshot_checksum(const uint8_t *records, size_t count, uint32_t *sum1, uint32_t *sum2)
+{
+    uint32_t a = *sum1;
+    uint32_t b = *sum2;
+    size_t words = count * (MC_CLOCK_SNAPSHOT_RECORD_SIZE / 4);
+
+    if (host_is_little_endian())
+    {
+        for (size_t i = 0; i < words; i++)
+        {
+            uint32_t w;
+            memcpy(&w, records + i * 4, 4);
+            a += w;
+            b += a;
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < words; i++)
+        {
+            a += get_le32(records + i * 4);
+            b += a;
+        }
+    }
+
+    *sum1 = a;
+    *sum2 = b;
+}// end snapshot_checksum
+
+static void snapshot_put_record(uint8_t *r, const mc_clock_t *_clock)
+{
+    put_le32(r, (uint32_t)_clock->timestamp);
+    put_le16(r + 4, _clock->datetime.year);
+    r[6] = _clock->datetime.month;
+    r[7] = _clock->datetime.day;
+    r[8] = _clock->datetime.hour;
+    r[9] = _clock->datetime.minute;
+    r[10] = _clock->datetime.second;
+    r[11] = 0;
+}// end snapshot_put_record
+
+static void snapshot_put_header(uint8_t *h, size_t count, uint32_t sum1, uint32_t sum2)
+{
+    memcpy(h, snapshot_magic, 4);
+    put_le16(h + 4, MC_CLOCK_SNAPSHOT_VERSION);
+    put_le16(h + 6, MC_CLOCK_SNAPSHOT_RECORD_SIZE);
+    put_le32(h + 8, (uint32_t)count);
+    put_le32(h + 12, 0);
+    put_le32(h + 16, sum1);
+    put_le32(h + 20, sum2);
+}// end snapshot_put_header
+
+size_t Mc_Clock_Snapshot_Size(size_t count)
+{
+    STAT_CALL(MC_CLOCK_STAT_SNAPSHOT_SIZE);
+    return MC_CLOCK_SNAPSHOT_HEADER_SIZE + count * MC_CLOCK_SNAPSHOT_RECORD_SIZE;
+}// end Mc_Clock_Snapshot_Size
+
+size_t Mc_Clock_Snapshot_Write(void *buffer, size_t size, void *const *clocks, size_t count)
+{
+    STAT_CALL(MC_CLOCK_STAT_SNAPSHOT_WRITE);
+    uint8_t *image = buffer;
+    size_t total = MC_CLOCK_SNAPSHOT_HEADER_SIZE + count * MC_CLOCK_SNAPSHOT_RECORD_SIZE;
+    uint32_t sum1 = 0;
+    uint32_t sum2 = 0;
+
+    if (size < total || count > UINT32_MAX)
+        return 0;
+
+    uint8_t *records = image + MC_CLOCK_SNAPSHOT_HEADER_SIZE;
+    for (size_t i = 0; i < count; i++)
+        snapshot_put_record(records + i * MC_CLOCK_SNAPSHOT_RECORD_SIZE, clocks[i]);
+
+    snapshot_checksum(records, count, &sum1, &sum2);
+    snapshot_put_header(image, count, sum1, sum2);
+
+    return total;
+}// end Mc_Clock_Snapshot_Write
+
+void *Mc_Clock_Snapshot_Open(void *image, size_t size, size_t *count)
+{
+    STAT_CALL(MC_CLOCK_STAT_SNAPSHOT_OPEN);
+    uint8_t *h = image;
+
+    // records are used as clocks in place
+    if (sizeof(mc_clock_t) != MC_CLOCK_SNAPSHOT_RECORD_SIZE || ((uintptr_t)image & 3) != 0)
+        return NULL;
+
+    if (size < MC_CLOCK_SNAPSHOT_HEADER_SIZE || memcmp(h, snapshot_magic, 4) != 0)
+        return NULL;
+
+    if (get_le16(h + 4) != MC_CLOCK_SNAPSHOT_VERSION || get_le16(h + 6) != MC_CLOCK_SNAPSHOT_RECORD_SIZE
+        || get_le32(h + 12) != 0)
+        return NULL;
+
+    size_t n = get_le32(h + 8);
+    if ((size - MC_CLOCK_SNAPSHOT_HEADER_SIZE) / MC_CLOCK_SNAPSHOT_RECORD_SIZE < n)
+        return NULL;
+
+    uint8_t *records = h + MC_CLOCK_SNAPSHOT_HEADER_SIZE;
+    uint32_t sum1 = 0;
+    uint32_t sum2 = 0;
+    snapshot_checksum(records, n, &sum1, &sum2);
+    if (sum1 != get_le32(h + 16) || sum2 != get_le32(h + 20))
+        return NULL;
+
+    // records become clocks without conversion: reject fields the clock functions can't handle.
+    // Byte 11 is the flags of an in-place clock: any other value than 0 would make it an object
+    for (size_t i = 0; i < n; i++)
+    {
+        const uint8_t *r = records + i * MC_CLOCK_SNAPSHOT_RECORD_SIZE;
+
+        if (r[6] == 0 || r[6] > 12 || r[7] == 0 || r[7] > days_in_month(r[6], get_le16(r + 4))
+            || r[8] > 23 || r[9] > 59 || r[10] > 59 || r[11] != 0)
+            return NULL;
+    }
+
+    // big-endian host: swap the records once. Image is no longer a valid snapshot afterwards.
+    if (!host_is_little_endian())
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            uint8_t *r = records + i * MC_CLOCK_SNAPSHOT_RECORD_SIZE;
+            mc_clock_t *_clock = (mc_clock_t *)r;
+            int32_t timestamp = (int32_t)get_le32(r);
+            uint16_t year = get_le16(r + 4);
+            _clock->timestamp = timestamp;
+            _clock->datetime.year = year;
+        }
+    }
+
+    *count = n;
+    return records;
+}// end Mc_Clock_Snapshot_Open
+
+void *Mc_Clock_Snapshot_Clock(void *storage, size_t index)
+{
+    STAT_CALL(MC_CLOCK_STAT_SNAPSHOT_CLOCK);
+    return (uint8_t *)storage + index * MC_CLOCK_SNAPSHOT_RECORD_SIZE;
+}// end Mc_Clock_Snapshot_Clock
+
+#ifdef MC_CLOCK_SNAPSHOT_FILES
+
+#define SNAPSHOT_CHUNK 1024
+
+int Mc_Clock_Snapshot_Save(const char *path, void *const *clocks, size_t count)
+{
+    STAT_CALL(MC_CLOCK_STAT_SNAPSHOT_SAVE);
+    uint8_t header[MC_CLOCK_SNAPSHOT_HEADER_SIZE] = {0};
+    uint8_t chunk[SNAPSHOT_CHUNK * MC_CLOCK_SNAPSHOT_RECORD_SIZE];
+    uint32_t sum1 = 0;
+    uint32_t sum2 = 0;
+
+    if (count > UINT32_MAX)
+        return -1;
+
+    FILE *f = fopen(path, "wb");
+    if (f == NULL)
+        return -1;
+
+    // header is rewritten once the checksum is known
+    int error = fwrite(header, sizeof(header), 1, f) != 1;
+
+    for (size_t i = 0; i < count && !error; i += SNAPSHOT_CHUNK)
+    {
+        size_t n = (count - i < SNAPSHOT_CHUNK) ? count - i : SNAPSHOT_CHUNK;
+
+        for (size_t j = 0; j < n; j++)
+            snapshot_put_record(chunk + j * MC_CLOCK_SNAPSHOT_RECORD_SIZE, clocks[i + j]);
+
+        snapshot_checksum(chunk, n, &sum1, &sum2);
+        error = fwrite(chunk, MC_CLOCK_SNAPSHOT_RECORD_SIZE, n, f) != n;
+    }
+
+    if (!error)
+    {
+        snapshot_put_header(header, count, sum1, sum2);
+        error = fseek(f, 0, SEEK_SET) != 0 || fwrite(header, sizeof(header), 1, f) != 1;
+    }
+
+    if (fclose(f) != 0)
+        error = 1;
+
+    return error ? -1 : 0;
+}// end Mc_Clock_Snapshot_Save
+
+void *Mc_Clock_Snapshot_Map(const char *path, size_t *count)
+{
+    STAT_CALL(MC_CLOCK_STAT_SNAPSHOT_MAP);
+    struct stat st;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+
+    if (fstat(fd, &st) != 0 || st.st_size < MC_CLOCK_SNAPSHOT_HEADER_SIZE)
+    {
+        close(fd);
+        return NULL;
+    }
+
+    // private mapping: restored clocks can be modified without touching the file
+    size_t size = (size_t)st.st_size;
+    void *image = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (image == MAP_FAILED)
+        return NULL;
+
+    void *storage = Mc_Clock_Snapshot_Open(image, size, count);
+
+    // Mc_Clock_Snapshot_Unmap() gets the mapping size back from the count
+    if (storage != NULL && size != MC_CLOCK_SNAPSHOT_HEADER_SIZE + *count * MC_CLOCK_SNAPSHOT_RECORD_SIZE)
+        storage = NULL;
+
+    if (storage == NULL)
+        munmap(image, size);
+
+    return storage;
+}// end Mc_Clock_Snapshot_Map
+
+void Mc_Clock_Snapshot_Unmap(void *storage, size_t count)
+{
+    STAT_CALL(MC_CLOCK_STAT_SNAPSHOT_UNMAP);
+    uint8_t *image = (uint8_t *)storage - MC_CLOCK_SNAPSHOT_HEADER_SIZE;
+
+    munmap(image, MC_CLOCK_SNAPSHOT_HEADER_SIZE + count * MC_CLOCK_SNAPSHOT_RECORD_SIZE);
+}// end Mc_Clock_Snapshot_Unmap
+
+#endif /* MC_CLOCK_SNAPSHOT_FILES */
+
+
+
+// ==================   RTC Registers   ================ //
+
+// canonical lanes of the SWAR vectors (one byte each)
+#define RTC_SECOND  0
+#define RTC_MINUTE  1
+#define RTC_HOUR    2
+#define RTC_DAY     3
+#define RTC_MONTH   4
+#define RTC_YEAR    5
+#define RTC_WEEKDAY 6
+
+#define RTC_LANE(v, lane) ((uint8_t)((v) >> ((lane) * 8)))
+
+#define SWAR_NIBBLES 0x0F0F0F0F0F0F0F0FULL
+#define SWAR_SIXES   0x0606060606060606ULL
+#define SWAR_CARRIES 0x1010101010101010ULL
+
+// register of each canonical lane
+static const uint8_t rtc_ds3231_position[7] = {0, 1, 2, 4, 5, 6, 3};
+static const uint8_t rtc_pcf8563_position[7] = {0, 1, 2, 3, 5, 6, 4};
+
+// 0 if a nibble of bcd is above 9
+static uint8_t bcd_is_valid(uint64_t bcd)
+{
+    // a nibble above 9 carries into bit 4 when adding 6
+    uint64_t low = ((bcd & SWAR_NIBBLES) + SWAR_SIXES) & SWAR_CARRIES;
+    uint64_t high = (((bcd >> 4) & SWAR_NIBBLES) + SWAR_SIXES) & SWAR_CARRIES;
+    return (low | high) == 0;
+}// end bcd_is_valid
+
+// BCD bytes to binary bytes: high * 10 + low, no carry between bytes
+static uint64_t bcd_decode(uint64_t bcd)
+{
+    return (bcd & SWAR_NIBBLES) + ((bcd >> 4) & SWAR_NIBBLES) * 10;
+}// end bcd_decode
+
+// binary bytes (<= 99) to BCD bytes, four 16 bit lanes at a time
+static uint64_t bcd_encode(uint64_t bin)
+{
+    uint64_t result = 0;
+
+    for (int half = 0; half < 2; half++)
+    {
+        // bytes of this half to 16 bit lanes
+        uint32_t bytes = (uint32_t)(bin >> (half * 32));
+        uint64_t v = (bytes & 0xFFULL) | ((uint64_t)(bytes & 0xFF00) << 8) | ((uint64_t)(bytes & 0xFF0000) << 16)
+                   | ((uint64_t)(bytes & 0xFF000000) << 24);
+
+        // v / 10 = (v * 103) >> 10, exact for v < 179
+        uint64_t tens = ((v * 103) >> 10) & 0x000F000F000F000FULL;
+        uint64_t bcd = (tens << 4) | (v - tens * 10);
+
+        // 16 bit lanes back to bytes
+        uint64_t packed = (bcd & 0xFF) | ((bcd >> 8) & 0xFF00) | ((bcd >> 16) & 0xFF0000) | ((bcd >> 24) & 0xFF000000);
+        result |= packed << (half * 32);
+    }
+
+    return result;
+}// end bcd_encode
+
+int Mc_Clock_From_RTC_BCD(void *clock, const uint8_t *registers, mc_clock_rtc_layout_t layout)
+{
+    STAT_CALL(MC_CLOCK_STAT_FROM_RTC_BCD);
+    mc_clock_t *_clock = clock;
+    uint8_t pcf8563 = (layout == MC_CLOCK_RTC_PCF8563);
+    uint8_t ds1307 = (layout == MC_CLOCK_RTC_DS1307);
+    const uint8_t *position = pcf8563 ? rtc_pcf8563_position : rtc_ds3231_position;
+
+    uint8_t hour = registers[position[RTC_HOUR]];
+    uint8_t month = registers[position[RTC_MONTH]];
+    uint8_t hour_12 = !pcf8563 && (hour & 0x40);
+
+    // voltage low (PCF8563) or oscillator halted (DS1307): time is not reliable
+    if ((pcf8563 || ds1307) && (registers[position[RTC_SECOND]] & 0x80))
+        return -1;
+
+    // gather time fields in canonical lanes, without control bits
+    uint64_t bcd = (uint64_t)(registers[position[RTC_SECOND]] & 0x7F)
+                 | (uint64_t)(registers[position[RTC_MINUTE]] & 0x7F) << (RTC_MINUTE * 8)
+                 | (uint64_t)(hour & (hour_12 ? 0x1F : 0x3F)) << (RTC_HOUR * 8)
+                 | (uint64_t)(registers[position[RTC_DAY]] & 0x3F) << (RTC_DAY * 8)
+                 | (uint64_t)(month & 0x1F) << (RTC_MONTH * 8)
+                 | (uint64_t)registers[position[RTC_YEAR]] << (RTC_YEAR * 8);
+
+    if (!bcd_is_valid(bcd))
+        return -1;
+
+    uint64_t bin = bcd_decode(bcd);
+    clock_datetime_t t;
+
+    t.second = RTC_LANE(bin, RTC_SECOND);
+    t.minute = RTC_LANE(bin, RTC_MINUTE);
+    t.hour = RTC_LANE(bin, RTC_HOUR);
+    t.day = RTC_LANE(bin, RTC_DAY);
+    t.month = RTC_LANE(bin, RTC_MONTH);
+
+    // century bit: DS3231 counts 21xx, PCF8563 19xx, DS1307 has none
+    if ((month & 0x80) && !ds1307)
+        t.year = (uint16_t)((pcf8563 ? 1900 : 2100) + RTC_LANE(bin, RTC_YEAR));
+    else
+        t.year = (uint16_t)(2000 + RTC_LANE(bin, RTC_YEAR));
+
+    if (hour_12)
+    {
+        if (t.hour == 0 || t.hour > 12)
+            return -1;
+
+        // 12 AM is 0h, 12 PM is 12h
+        t.hour = (uint8_t)((t.hour % 12) + ((hour & 0x20) ? 12 : 0));
+    }
+
+    if (t.second > 59 || t.minute > 59 || t.hour > 23 || t.month == 0 || t.month > 12)
+        return -1;
+
+    if (t.year > 2036 || t.year < 1901 || t.day == 0 || t.day > days_in_month(t.month, t.year))
+        return -1;
+
+    ROLLOVER_BEGIN(_clock);
+    set_datetime(_clock, t);
+    _clock->timestamp = Mc_Clock_Human_Date_To_Timestamp(&t);
+
+    ROLLOVER_END(_clock);
+    return 0;
+}// end Mc_Clock_From_RTC_BCD
+
+int Mc_Clock_To_RTC_BCD(void *clock, uint8_t *registers, mc_clock_rtc_layout_t layout)
+{
+    STAT_CALL(MC_CLOCK_STAT_TO_RTC_BCD);
+    mc_clock_t *_clock = clock;
+    const clock_datetime_t *t = &(_clock->datetime);
+    uint8_t pcf8563 = (layout == MC_CLOCK_RTC_PCF8563);
+    const uint8_t *position = pcf8563 ? rtc_pcf8563_position : rtc_ds3231_position;
+
+    // two year digits and the century bit: 2000-2199 (DS3231) or 1900-2099 (PCF8563). DS1307: 2000-2099
+    uint16_t last_year = (pcf8563 || layout == MC_CLOCK_RTC_DS1307) ? 2099 : 2199;
+    if (t->year < (pcf8563 ? 1900 : 2000) || t->year > last_year)
+        return -1;
+
+    uint8_t weekday = days_weekday(timestamp_days(_clock->timestamp));
+
+    uint8_t hour = t->hour;
+    uint8_t hour_flags = 0;
+    if (layout == MC_CLOCK_RTC_DS3231_12H)
+    {
+        hour_flags = (t->hour >= 12) ? 0x60 : 0x40;
+        hour = (t->hour % 12 == 0) ? 12 : t->hour % 12;
+    }
+
+    uint64_t bin = (uint64_t)t->second
+                 | (uint64_t)t->minute << (RTC_MINUTE * 8)
+                 | (uint64_t)hour << (RTC_HOUR * 8)
+                 | (uint64_t)t->day << (RTC_DAY * 8)
+                 | (uint64_t)t->month << (RTC_MONTH * 8)
+                 | (uint64_t)(t->year % 100) << (RTC_YEAR * 8)
+                 | (uint64_t)(pcf8563 ? weekday : weekday + 1) << (RTC_WEEKDAY * 8);
+
+    uint64_t bcd = bcd_encode(bin);
+
+    for (int lane = 0; lane < MC_CLOCK_RTC_BLOCK_SIZE; lane++)
+        registers[position[lane]] = RTC_LANE(bcd, lane);
+
+    registers[position[RTC_HOUR]] |= hour_flags;
+
+    if (pcf8563 ? (t->year < 2000) : (t->year >= 2100))
+        registers[position[RTC_MONTH]] |= 0x80;
+
+    return 0;
+}// end Mc_Clock_To_RTC_BCD
+
+
+
+// ==================   Day Cache   ================ //
+
+#ifdef MC_CLOCK_DAY_CACHE
+
+void Mc_Clock_Day_Cache_Get_Stats(mc_clock_day_cache_stats_t *stats)
+{
+    STAT_CALL(MC_CLOCK_STAT_DAY_CACHE_GET_STATS);
+    *stats = day_cache_stats;
+}// end Mc_Clock_Day_Cache_Get_Stats
+
+void Mc_Clock_Day_Cache_Clear(void)
+{
+    STAT_CALL(MC_CLOCK_STAT_DAY_CACHE_CLEAR);
+    memset(day_cache, 0, sizeof(day_cache));
+    memset(&day_cache_stats, 0, sizeof(day_cache_stats));
+}// end Mc_Clock_Day_Cache_Clear
+
+#endif /* MC_CLOCK_DAY_CACHE */
+
+
+
+// ==================   Statistics   ================ //
+
+#ifdef MC_CLOCK_STATS
+
+static const char *const stats_function_names[MC_CLOCK_STAT_FN_COUNT] = {
+    "Mc_Clock_New",
+    "Mc_Clock_Clone",
+    "Mc_Clock_Destroy",
+    "Mc_Clock_Clear_Time",
+    "Mc_Clock_Clear_DateTime",
+    "Mc_Clock_Set_Timestamp",
+    "Mc_Clock_Set_Second",
+    "Mc_Clock_Set_Minute",
+    "Mc_Clock_Set_Hour",
+    "Mc_Clock_Set_Time",
+    "Mc_Clock_Set_Day",
+    "Mc_Clock_Set_Month",
+    "Mc_Clock_Set_Year",
+    "Mc_Clock_Set_Date",
+    "Mc_Clock_Get_Timestamp",
+    "Mc_Clock_Get_Second",
+    "Mc_Clock_Get_Minute",
+    "Mc_Clock_Get_Hour",
+    "Mc_Clock_Get_Day",
+    "Mc_Clock_Get_Month",
+    "Mc_Clock_Get_Year",
+    "Mc_Clock_Increment_Timestamp",
+    "Mc_Clock_Increment_Timestamp_Value",
+    "Mc_Clock_Increment_Second",
+    "Mc_Clock_Increment_Minute",
+    "Mc_Clock_Increment_Hour",
+    "Mc_Clock_Increment_Day",
+    "Mc_Clock_Increment_Month",
+    "Mc_Clock_Increment_Year",
+    "Mc_Clock_Decrement_Timestamp",
+    "Mc_Clock_Decrement_Timestamp_Value",
+    "Mc_Clock_Decrement_Second",
+    "Mc_Clock_Decrement_Minute",
+    "Mc_Clock_Decrement_Hour",
+    "Mc_Clock_Decrement_Day",
+    "Mc_Clock_Decrement_Month",
+    "Mc_Clock_Decrement_Year",
+    "Mc_Clock_Set_System_Source",
+    "Mc_Clock_Sync_System",
+    "Mc_Clock_Snapshot_Size",
+    "Mc_Clock_Snapshot_Write",
+    "Mc_Clock_Snapshot_Open",
+    "Mc_Clock_Snapshot_Clock",
+    "Mc_Clock_Snapshot_Save",
+    "Mc_Clock_Snapshot_Map",
+    "Mc_Clock_Snapshot_Unmap",
+    "Mc_Clock_Date_To_Timestamp",
+    "Mc_Clock_From_RTC_BCD",
+    "Mc_Clock_To_RTC_BCD",
+    "Mc_Clock_Day_Cache_Get_Stats",
+    "Mc_Clock_Day_Cache_Clear",
+    "Mc_Clock_Date_To_Days",
+    "Mc_Clock_Timestamp_To_Days",
+    "Mc_Clock_Is_Leap_Year",
+    "Mc_Clock_Days_In_Month",
+    "Mc_Clock_Days_To_Weekday",
+    "Mc_Clock_Split_Time_Of_Day",
+    "Mc_Clock_On_Rollover",
+    "Mc_Clock_Compare",
+    "Mc_Clock_Sort",
+    "Mc_Clock_Sort_Parallel",
+};
+
+void Mc_Clock_Stats_Get(mc_clock_stats_t *out)
+{
+    *out = stats_counters;
+}// end Mc_Clock_Stats_Get
+
+void Mc_Clock_Stats_Reset(void)
+{
+    static const mc_clock_stats_t zero;
+    stats_counters = zero;
+}// end Mc_Clock_Stats_Reset
+
+const char *Mc_Clock_Stats_Function_Name(mc_clock_stat_fn_t fn)
+{
+    if ((unsigned)fn >= MC_CLOCK_STAT_FN_COUNT)
+        return "";
+
+    return stats_function_names[fn];
+}// end Mc_Clock_Stats_Function_Name
+
+// append to buffer like snprintf, keeping the total length
+static void stats_append(char *buffer, size_t size, size_t *len, const char *fmt, ...)
+{
+    va_list args;
+    size_t used = (*len < size) ? *len : size;
+
+    va_start(args, fmt);
+    int n = vsnprintf(buffer ? buffer + used : NULL, size - used, fmt, args);
+    va_end(args);
+
+    if (n > 0)
+        *len += (size_t)n;
+}// end stats_append
+
+static void stats_dump_conversion(char *buffer, size_t size, size_t *len, mc_clock_stats_format_t format,
+                                  const char *name, const mc_clock_stats_conversion_t *c)
+{
+    uint64_t average = c->samples ? c->cycles / c->samples : 0;
+
+    if (format == MC_CLOCK_STATS_JSON)
+    {
+        stats_append(buffer, size, len,
+                     "\"%s\":{\"conversions\":%llu,\"year_iterations\":%llu,\"month_iterations\":%llu,"
+                     "\"samples\":%llu,\"cycles\":%llu,\"cycles_per_conversion\":%llu}",
+                     name, (unsigned long long)c->conversions, (unsigned long long)c->year_iterations,
+                     (unsigned long long)c->month_iterations, (unsigned long long)c->samples,
+                     (unsigned long long)c->cycles, (unsigned long long)average);
+    }
+    else
+    {
+        stats_append(buffer, size, len,
+                     "%s: %llu conversions, %llu year iterations, %llu month iterations, %llu cycles/conversion\n",
+                     name, (unsigned long long)c->conversions, (unsigned long long)c->year_iterations,
+                     (unsigned long long)c->month_iterations, (unsigned long long)average);
+    }
+}// end stats_dump_conversion
+
+size_t Mc_Clock_Stats_Dump(char *buffer, size_t size, mc_clock_stats_format_t format)
+{
+    size_t len = 0;
+    uint8_t first = 1;
+
+    if (buffer == NULL)
+        size = 0;
+    else if (size > 0)
+        buffer[0] = '\0';
+
+    if (format == MC_CLOCK_STATS_JSON)
+        stats_append(buffer, size, &len, "{\"calls\":{");
+
+    // only functions that were called
+    for (int fn = 0; fn < MC_CLOCK_STAT_FN_COUNT; fn++)
+    {
+        if (stats_counters.calls[fn] == 0)
+            continue;
+
+        if (format == MC_CLOCK_STATS_JSON)
+            stats_append(buffer, size, &len, "%s\"%s\":%llu", first ? "" : ",",
+                         stats_function_names[fn], (unsigned long long)stats_counters.calls[fn]);
+        else
+            stats_append(buffer, size, &len, "%s: %llu\n", stats_function_names[fn],
+                         (unsigned long long)stats_counters.calls[fn]);
+        first = 0;
+    }
+
+    if (format == MC_CLOCK_STATS_JSON)
+    {
+        stats_append(buffer, size, &len, "},");
+        stats_dump_conversion(buffer, size, &len, format, "to_human_date", &stats_counters.to_human_date);
+        stats_append(buffer, size, &len, ",");
+        stats_dump_conversion(buffer, size, &len, format, "to_timestamp", &stats_counters.to_timestamp);
+        stats_append(buffer, size, &len, "}");
+    }
+    else
+    {
+        stats_dump_conversion(buffer, size, &len, format, "to_human_date", &stats_counters.to_human_date);
+        stats_dump_conversion(buffer, size, &len, format, "to_timestamp", &stats_counters.to_timestamp);
+    }
+
+    return len;
+}// end Mc_Clock_Stats_Dump
+
+#endif /* MC_CLOCK_STATS */
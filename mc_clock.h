@@ -297,6 +297,422 @@ void Mc_Clock_Decrement_Month(void * clock);
 void Mc_Clock_Decrement_Year(void * clock);
 
 
+
+
+// ==================   Rollover Events   ================ //
+
+/**
+ * @brief Rollover levels, dispatched in this order
+ */
+typedef enum
+{
+    MC_CLOCK_LEVEL_MINUTE = 0,
+    MC_CLOCK_LEVEL_HOUR,
+    MC_CLOCK_LEVEL_DAY,
+    MC_CLOCK_LEVEL_MONTH,
+    MC_CLOCK_LEVEL_YEAR,
+    MC_CLOCK_LEVEL_COUNT
+} mc_clock_level_t;
+
+/**
+ * @brief Called when the clock enters a new minute, hour, day, month or year
+ * @param boundary Timestamp where the new period starts
+ * @note Callbacks must not change the clock that called them.
+ */
+typedef void (*mc_clock_rollover_callback_t)(void * clock, mc_clock_level_t level, int32_t boundary, void * context);
+
+/**
+ * @brief Register the callback of a rollover level (NULL callback removes it). <br>
+ * Every setter, incrementer, decrementer and sync compares the datetime it updated and calls each changed level
+ * once, from minute to year. With <replay>, a forward move calls the level once per boundary crossed instead
+ * (a 3 days jump: 3 day callbacks).
+ * @return 0 on success, -1 if out of memory or clock was not created by Mc_Clock_New()/Mc_Clock_Clone()
+ * @note Callbacks are not copied by Mc_Clock_Clone().
+ */
+int Mc_Clock_On_Rollover(void * clock, mc_clock_level_t level, mc_clock_rollover_callback_t callback, void * context, uint8_t replay);
+
+
+
+// ==================   Conversion   ================ //
+
+/**
+ * @brief Convert a date and time to epoch timestamp, without a clock object
+ * @return Timestamp, INT32_MIN if month or day is not valid
+ */
+int32_t Mc_Clock_Date_To_Timestamp(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second);
+
+/**
+ * @brief Convert a date to days since 1/jan/1970 (closed form, no loops). Date must be valid.
+ * @note Weekday of the date: (days + 4) mod 7, 0 = sunday
+ */
+int32_t Mc_Clock_Date_To_Days(uint16_t year, uint8_t month, uint8_t day);
+
+/**
+ * @brief Convert a timestamp to days since 1/jan/1970, rounded down (days before 1970 are negative)
+ * @note Accepts int64_t so range ends past the int32_t timestamps can be converted too
+ */
+int32_t Mc_Clock_Timestamp_To_Days(int64_t timestamp);
+
+/**
+ * @brief Verify if the year is a leap year (gregorian)
+ *
+ */
+uint8_t Mc_Clock_Is_Leap_Year(uint16_t year);
+
+/**
+ * @brief Get the number of days of the month in the year
+ * @return 28-31, 0 if month is not valid
+ */
+uint8_t Mc_Clock_Days_In_Month(uint8_t month, uint16_t year);
+
+/**
+ * @brief Get the weekday of a day number (days since 1/jan/1970, as Mc_Clock_Date_To_Days())
+ * @return 0 = sunday to 6 = saturday
+ */
+uint8_t Mc_Clock_Days_To_Weekday(int32_t days);
+
+/**
+ * @brief Split a second of the day (0-86399) into hour, minute and second, without division
+ *
+ */
+void Mc_Clock_Split_Time_Of_Day(uint32_t seconds, uint8_t * hour, uint8_t * minute, uint8_t * second);
+
+
+
+// ==================   Comparison and Sorting   ================ //
+
+#include <stddef.h>
+
+/**
+ * @brief Compare clocks by timestamp
+ * @return -1 if a is before b, 0 if equal, 1 if a is after b
+ */
+int Mc_Clock_Compare(void * a, void * b);
+
+/**
+ * @brief Sort clocks by timestamp (stable). Timestamps are read once, then sorted by LSD radix.
+ * @return 0 on success, -1 if out of memory (clocks are not changed)
+ */
+int Mc_Clock_Sort(void ** clocks, size_t count);
+
+#ifdef MC_CLOCK_THREADS
+
+/**
+ * @brief Same as Mc_Clock_Sort(), split between <threads> threads (needs pthreads)
+ *
+ */
+int Mc_Clock_Sort_Parallel(void ** clocks, size_t count, unsigned threads);
+
+#endif /* MC_CLOCK_THREADS */
+
+
+
+// ==================   System Time   ================ //
+
+#if !defined(MC_CLOCK_NO_SYSTEM) && (defined(__unix__) || defined(__APPLE__))
+#define MC_CLOCK_SYSTEM 1
+#endif
+
+#ifdef MC_CLOCK_SYSTEM
+
+/**
+ * @brief Host time sources read by Mc_Clock_Sync_System()
+ */
+typedef enum
+{
+    MC_CLOCK_SOURCE_REALTIME = 0,   ///< CLOCK_REALTIME: precise, follows wall-clock steps
+    MC_CLOCK_SOURCE_REALTIME_COARSE,///< CLOCK_REALTIME_COARSE: tick resolution, cheapest read (default)
+    MC_CLOCK_SOURCE_MONOTONIC       ///< Wall time latched once, then advanced by the monotonic clock
+} mc_clock_source_t;
+
+/**
+ * @brief Select the host time source used by every "now" clock.
+ * @note With MC_CLOCK_SOURCE_MONOTONIC the wall time is latched here, so call it once at startup.
+ *       Later wall-clock steps (NTP, settimeofday) are then ignored.
+ */
+void Mc_Clock_Set_System_Source(mc_clock_source_t source);
+
+/**
+ * @brief Load the current system time into the clock and return its timestamp. <br>
+ * Datetime is only refreshed when the second changed, and without the full date conversion
+ * while the day stays the same. Cheap enough to be called on every request.
+ */
+int32_t Mc_Clock_Sync_System(void * clock);
+
+#endif /* MC_CLOCK_SYSTEM */
+
+
+
+// ==================   Snapshot   ================ //
+
+/**
+ * Snapshot image (version 1), all fields little-endian: <br>
+ *  - header, 24 bytes: offset 0 magic "MCCS", 4 uint16 version, 6 uint16 record size (12), 8 uint32 count,
+ *    12 uint32 reserved (0), 16 uint32 sum1, 20 uint32 sum2 <br>
+ *  - count records of 12 bytes: int32 timestamp, uint16 year, uint8 month, day, hour, minute, second,
+ *    uint8 reserved (0) <br>
+ *  - checksum (Fletcher style, sums modulo 2^32) over the records read as little-endian uint32 words w:
+ *    sum1 += w, then sum2 += sum1, both starting at 0 <br>
+ * A record has the layout of a clock object, so restored records are used as clocks in place.
+ */
+#define MC_CLOCK_SNAPSHOT_VERSION       1
+#define MC_CLOCK_SNAPSHOT_HEADER_SIZE   24
+#define MC_CLOCK_SNAPSHOT_RECORD_SIZE   12
+
+/**
+ * @brief Bytes needed by a snapshot image of <count> clocks
+ */
+size_t Mc_Clock_Snapshot_Size(size_t count);
+
+/**
+ * @brief Write the snapshot image of <count> clocks into buffer
+ * @return Bytes written, 0 if buffer is too small
+ */
+size_t Mc_Clock_Snapshot_Write(void * buffer, size_t size, void * const * clocks, size_t count);
+
+/**
+ * @brief Validate a snapshot image and return its clock storage (no conversion per clock)
+ * @param image Snapshot image, 4-byte aligned (records are cast to clocks)
+ * @param count Receives the number of clocks in the image
+ * @return Storage of the first clock, NULL if image is invalid (misaligned, bad header, checksum, a reserved field
+ *         not 0 or a record with an invalid date or time). Use Mc_Clock_Snapshot_Clock() to get each clock.
+ * @note The image must stay valid and writable while its clocks are used. Big-endian hosts swap records in place.
+ * @note Restored clocks are not allocated: never call Mc_Clock_Destroy() on them.
+ */
+void * Mc_Clock_Snapshot_Open(void * image, size_t size, size_t * count);
+
+/**
+ * @brief Get clock <index> of the storage returned by Mc_Clock_Snapshot_Open() or Mc_Clock_Snapshot_Map()
+ */
+void * Mc_Clock_Snapshot_Clock(void * storage, size_t index);
+
+#if !defined(MC_CLOCK_NO_SNAPSHOT_FILES) && (defined(__unix__) || defined(__APPLE__))
+#define MC_CLOCK_SNAPSHOT_FILES 1
+#endif
+
+#ifdef MC_CLOCK_SNAPSHOT_FILES
+
+/**
+ * @brief Save <count> clocks into a snapshot file
+ * @return 0 on success, -1 on error
+ */
+int Mc_Clock_Snapshot_Save(const char * path, void * const * clocks, size_t count);
+
+/**
+ * @brief Map a snapshot file (copy on write) and return its clock storage, as Mc_Clock_Snapshot_Open()
+ * @return Storage of the first clock, NULL on error. Release it with Mc_Clock_Snapshot_Unmap().
+ */
+void * Mc_Clock_Snapshot_Map(const char * path, size_t * count);
+
+/**
+ * @brief Unmap the clock storage returned by Mc_Clock_Snapshot_Map()
+ */
+void Mc_Clock_Snapshot_Unmap(void * storage, size_t count);
+
+#endif /* MC_CLOCK_SNAPSHOT_FILES */
+
+
+
+// ==================   RTC Registers   ================ //
+
+/**
+ * @brief Size of the BCD time register block (seconds to year)
+ */
+#define MC_CLOCK_RTC_BLOCK_SIZE 7
+
+/**
+ * @brief RTC time register layouts, block starting at the seconds register
+ */
+typedef enum
+{
+    /**
+     * DS3231 (registers 0x00-0x06): seconds, minutes, hours, weekday (1-7, 1 = sunday), date,
+     * month (bit 7 = century, year 21xx), year. Holds 2000-2199. Hours are read in 12 or 24 hour mode, written in 24.
+     */
+    MC_CLOCK_RTC_DS3231 = 0,
+    /**
+     * Same as MC_CLOCK_RTC_DS3231, hours written in 12 hour mode
+     */
+    MC_CLOCK_RTC_DS3231_12H,
+    /**
+     * PCF8563 (registers 0x02-0x08): seconds (bit 7 = voltage low), minutes, hours, days, weekday (0-6, 0 = sunday),
+     * month (bit 7 = century, set for 19xx), year. Holds 1900-2099. 24 hour mode only.
+     */
+    MC_CLOCK_RTC_PCF8563,
+    /**
+     * DS1307 (registers 0x00-0x06): as MC_CLOCK_RTC_DS3231 with seconds bit 7 = clock halt and no century bit.
+     * Holds 2000-2099. Written with the clock halt bit cleared (oscillator running).
+     */
+    MC_CLOCK_RTC_DS1307
+} mc_clock_rtc_layout_t;
+
+/**
+ * @brief Load clock from an RTC BCD register block, with one timestamp update
+ * @return 0 on success, -1 if registers hold an invalid date or time (clock is not changed). <br>
+ * PCF8563 blocks with the voltage low flag set and DS1307 blocks with the clock halt flag set are invalid.
+ */
+int Mc_Clock_From_RTC_BCD(void * clock, const uint8_t * registers, mc_clock_rtc_layout_t layout);
+
+/**
+ * @brief Write clock datetime into an RTC BCD register block (MC_CLOCK_RTC_BLOCK_SIZE bytes)
+ * @return 0 on success, -1 if the year is out of the range the chip holds (registers are not written)
+ */
+int Mc_Clock_To_RTC_BCD(void * clock, uint8_t * registers, mc_clock_rtc_layout_t layout);
+
+
+
+// ==================   Day Cache   ================ //
+
+/**
+ * Build with -DMC_CLOCK_DAY_CACHE=<entries> (power of 2) to keep, per thread, the year/month/day of the last
+ * converted days. Timestamp conversions that hit the cache skip the year and month walk.
+ */
+#ifdef MC_CLOCK_DAY_CACHE
+
+typedef struct
+{
+    uint64_t hits;
+    uint64_t misses;
+} mc_clock_day_cache_stats_t;
+
+/**
+ * @brief Get day cache hits and misses of the calling thread
+ */
+void Mc_Clock_Day_Cache_Get_Stats(mc_clock_day_cache_stats_t * stats);
+
+/**
+ * @brief Empty the day cache of the calling thread and clear its counters
+ */
+void Mc_Clock_Day_Cache_Clear(void);
+
+#endif /* MC_CLOCK_DAY_CACHE */
+
+
+
+// ==================   Statistics   ================ //
+
+#ifdef MC_CLOCK_STATS
+
+/**
+ * @brief Public functions counted by the statistics (index of mc_clock_stats_t.calls)
+ */
+typedef enum
+{
+    MC_CLOCK_STAT_NEW,
+    MC_CLOCK_STAT_CLONE,
+    MC_CLOCK_STAT_DESTROY,
+    MC_CLOCK_STAT_CLEAR_TIME,
+    MC_CLOCK_STAT_CLEAR_DATETIME,
+    MC_CLOCK_STAT_SET_TIMESTAMP,
+    MC_CLOCK_STAT_SET_SECOND,
+    MC_CLOCK_STAT_SET_MINUTE,
+    MC_CLOCK_STAT_SET_HOUR,
+    MC_CLOCK_STAT_SET_TIME,
+    MC_CLOCK_STAT_SET_DAY,
+    MC_CLOCK_STAT_SET_MONTH,
+    MC_CLOCK_STAT_SET_YEAR,
+    MC_CLOCK_STAT_SET_DATE,
+    MC_CLOCK_STAT_GET_TIMESTAMP,
+    MC_CLOCK_STAT_GET_SECOND,
+    MC_CLOCK_STAT_GET_MINUTE,
+    MC_CLOCK_STAT_GET_HOUR,
+    MC_CLOCK_STAT_GET_DAY,
+    MC_CLOCK_STAT_GET_MONTH,
+    MC_CLOCK_STAT_GET_YEAR,
+    MC_CLOCK_STAT_INCREMENT_TIMESTAMP,
+    MC_CLOCK_STAT_INCREMENT_TIMESTAMP_VALUE,
+    MC_CLOCK_STAT_INCREMENT_SECOND,
+    MC_CLOCK_STAT_INCREMENT_MINUTE,
+    MC_CLOCK_STAT_INCREMENT_HOUR,
+    MC_CLOCK_STAT_INCREMENT_DAY,
+    MC_CLOCK_STAT_INCREMENT_MONTH,
+    MC_CLOCK_STAT_INCREMENT_YEAR,
+    MC_CLOCK_STAT_DECREMENT_TIMESTAMP,
+    MC_CLOCK_STAT_DECREMENT_TIMESTAMP_VALUE,
+    MC_CLOCK_STAT_DECREMENT_SECOND,
+    MC_CLOCK_STAT_DECREMENT_MINUTE,
+    MC_CLOCK_STAT_DECREMENT_HOUR,
+    MC_CLOCK_STAT_DECREMENT_DAY,
+    MC_CLOCK_STAT_DECREMENT_MONTH,
+    MC_CLOCK_STAT_DECREMENT_YEAR,
+    MC_CLOCK_STAT_SET_SYSTEM_SOURCE,
+    MC_CLOCK_STAT_SYNC_SYSTEM,
+    MC_CLOCK_STAT_SNAPSHOT_SIZE,
+    MC_CLOCK_STAT_SNAPSHOT_WRITE,
+    MC_CLOCK_STAT_SNAPSHOT_OPEN,
+    MC_CLOCK_STAT_SNAPSHOT_CLOCK,
+    MC_CLOCK_STAT_SNAPSHOT_SAVE,
+    MC_CLOCK_STAT_SNAPSHOT_MAP,
+    MC_CLOCK_STAT_SNAPSHOT_UNMAP,
+    MC_CLOCK_STAT_DATE_TO_TIMESTAMP,
+    MC_CLOCK_STAT_FROM_RTC_BCD,
+    MC_CLOCK_STAT_TO_RTC_BCD,
+    MC_CLOCK_STAT_DAY_CACHE_GET_STATS,
+    MC_CLOCK_STAT_DAY_CACHE_CLEAR,
+    MC_CLOCK_STAT_DATE_TO_DAYS,
+    MC_CLOCK_STAT_TIMESTAMP_TO_DAYS,
+    MC_CLOCK_STAT_IS_LEAP_YEAR,
+    MC_CLOCK_STAT_DAYS_IN_MONTH,
+    MC_CLOCK_STAT_DAYS_TO_WEEKDAY,
+    MC_CLOCK_STAT_SPLIT_TIME_OF_DAY,
+    MC_CLOCK_STAT_ON_ROLLOVER,
+    MC_CLOCK_STAT_COMPARE,
+    MC_CLOCK_STAT_SORT,
+    MC_CLOCK_STAT_SORT_PARALLEL,
+    MC_CLOCK_STAT_FN_COUNT
+} mc_clock_stat_fn_t;
+
+/**
+ * @brief Conversion counters of one direction (timestamp -> datetime or datetime -> timestamp)
+ */
+typedef struct
+{
+    uint64_t conversions;       ///< number of conversions
+    uint64_t year_iterations;   ///< iterations of the year loop
+    uint64_t month_iterations;  ///< iterations of the month loop
+    uint64_t samples;           ///< conversions that were timed
+    uint64_t cycles;            ///< cycles spent by the timed conversions (ns where no cycle counter)
+} mc_clock_stats_conversion_t;
+
+/**
+ * @brief Hot path counters of the calling thread
+ */
+typedef struct
+{
+    uint64_t calls[MC_CLOCK_STAT_FN_COUNT];
+    mc_clock_stats_conversion_t to_human_date;
+    mc_clock_stats_conversion_t to_timestamp;
+} mc_clock_stats_t;
+
+typedef enum
+{
+    MC_CLOCK_STATS_TEXT = 0,
+    MC_CLOCK_STATS_JSON
+} mc_clock_stats_format_t;
+
+/**
+ * @brief Copy the counters of the calling thread
+ */
+void Mc_Clock_Stats_Get(mc_clock_stats_t * stats);
+
+/**
+ * @brief Clear the counters of the calling thread
+ */
+void Mc_Clock_Stats_Reset(void);
+
+/**
+ * @brief Get the function name of a calls[] index
+ */
+const char * Mc_Clock_Stats_Function_Name(mc_clock_stat_fn_t fn);
+
+/**
+ * @brief Write the counters of the calling thread as text or JSON into buffer.
+ * @return Length of the full dump (as snprintf). Output is truncated if >= size.
+ */
+size_t Mc_Clock_Stats_Dump(char * buffer, size_t size, mc_clock_stats_format_t format);
+
+#endif /* MC_CLOCK_STATS */
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,297 @@
+/**
+ * @file mc_clock_array.c
+ */
+
+#include "mc_clock_array.h"
+#include "mc_clock.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define SECONDS_PER_DAY 86400
+// clocks advanced before their dates are fixed (block stays in cache)
+#define ARRAY_BLOCK     256
+
+typedef struct
+{
+    size_t count;
+    int32_t *timestamps;
+    int32_t *seconds;   // second of day, 0-86399
+    int32_t *days;      // days since 1/jan/1970
+    uint16_t *years;
+    uint8_t *months;
+    uint8_t *mdays;
+} clock_array_t;
+
+
+// ##############################  PRIVATE FUNCTIONS  ################################# //
+
+// inverse of Mc_Clock_Date_To_Days()
+static void date_of(int32_t days, uint16_t *year, uint8_t *month, uint8_t *day)
+{
+    int32_t z = days + 719468;
+    int32_t era = ((z >= 0) ? z : z - 146096) / 146097;
+    uint32_t doe = (uint32_t)(z - era * 146097);
+    uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    uint32_t mp = (5 * doy + 2) / 153;
+    uint32_t m = (mp < 10) ? mp + 3 : mp - 9;
+
+    *year = (uint16_t)((int32_t)yoe + era * 400 + (m <= 2));
+    *month = (uint8_t)m;
+    *day = (uint8_t)(doy - (153 * mp + 2) / 5 + 1);
+}// end date_of
+
+static void set_lane(clock_array_t *a, size_t i, int32_t timestamp)
+{
+    int32_t days = Mc_Clock_Timestamp_To_Days(timestamp);
+
+    a->timestamps[i] = timestamp;
+    a->days[i] = days;
+    a->seconds[i] = (int32_t)(timestamp - (int64_t)days * SECONDS_PER_DAY);
+    date_of(days, &a->years[i], &a->months[i], &a->mdays[i]);
+}// end set_lane
+
+// add d (0 where mask is 0) to the timestamps and seconds of day. Not 0 if a clock left its day or wrapped
+static uint32_t advance_block(int32_t *restrict timestamps, int32_t *restrict seconds, const uint8_t *restrict mask,
+                              size_t count, int32_t delta)
+{
+    uint32_t crossed = 0;
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bias = _mm_set1_epi32(INT32_MIN);
+    const __m128i limit = _mm_set1_epi32(INT32_MIN + SECONDS_PER_DAY - 1);
+    __m128i any = zero;
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i d = _mm_set1_epi32(delta);
+        if (mask != NULL)
+        {
+            int32_t bytes;
+            memcpy(&bytes, mask + i, sizeof(bytes));
+            __m128i lanes = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), zero), zero);
+            d = _mm_andnot_si128(_mm_cmpeq_epi32(lanes, zero), d);
+        }
+
+        __m128i old = _mm_loadu_si128((const __m128i *)(timestamps + i));
+        __m128i now = _mm_add_epi32(old, d);
+        __m128i second = _mm_add_epi32(_mm_loadu_si128((const __m128i *)(seconds + i)), d);
+
+        // sign bit set where the lane crossed (unsigned compare through the biased signed one)
+        any = _mm_or_si128(any, _mm_cmpgt_epi32(_mm_xor_si128(second, bias), limit));
+        any = _mm_or_si128(any, _mm_and_si128(_mm_xor_si128(old, now), _mm_xor_si128(d, now)));
+
+        _mm_storeu_si128((__m128i *)(timestamps + i), now);
+        _mm_storeu_si128((__m128i *)(seconds + i), second);
+    }
+
+    crossed = (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(any));
+#endif
+
+    for (; i < count; i++)
+    {
+        uint32_t d = (uint32_t)delta;
+        if (mask != NULL)
+            d &= 0 - (uint32_t)(mask[i] != 0);
+
+        uint32_t old = (uint32_t)timestamps[i];
+        uint32_t now = old + d;
+        uint32_t second = (uint32_t)seconds[i] + d;
+
+        // out of 0-86399 (unsigned compare), or signed overflow of the timestamp
+        crossed |= (uint32_t)(second >= SECONDS_PER_DAY) | (((old ^ now) & (d ^ now)) >> 31);
+
+        timestamps[i] = (int32_t)now;
+        seconds[i] = (int32_t)second;
+    }
+
+    return crossed;
+}// end advance_block
+
+// recompute the dates of the clocks whose second of day no longer matches their day
+static void fix_block(clock_array_t *a, size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; i++)
+    {
+        if ((uint32_t)a->seconds[i] >= SECONDS_PER_DAY
+            || (int64_t)a->days[i] * SECONDS_PER_DAY + a->seconds[i] != a->timestamps[i])
+        {
+            set_lane(a, i, a->timestamps[i]);
+        }
+    }
+}// end fix_block
+
+static void advance(clock_array_t *a, const uint8_t *mask, int32_t delta)
+{
+    for (size_t begin = 0; begin < a->count; begin += ARRAY_BLOCK)
+    {
+        size_t n = (a->count - begin < ARRAY_BLOCK) ? a->count - begin : ARRAY_BLOCK;
+
+        if (advance_block(a->timestamps + begin, a->seconds + begin, (mask != NULL) ? mask + begin : NULL, n, delta))
+            fix_block(a, begin, begin + n);
+    }
+}// end advance
+
+static uint16_t field_of(const clock_array_t *a, size_t i, mc_clock_array_field_t field)
+{
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t second;
+    Mc_Clock_Split_Time_Of_Day((uint32_t)a->seconds[i], &hour, &minute, &second);
+
+    switch (field)
+    {
+    case MC_CLOCK_ARRAY_YEAR:
+        return a->years[i];
+    case MC_CLOCK_ARRAY_MONTH:
+        return a->months[i];
+    case MC_CLOCK_ARRAY_DAY:
+        return a->mdays[i];
+    case MC_CLOCK_ARRAY_HOUR:
+        return hour;
+    case MC_CLOCK_ARRAY_MINUTE:
+        return minute;
+    default:
+        return second;
+    }
+}// end field_of
+
+
+
+
+// ##############################  PUBLIC FUNCTIONS  ################################# //
+
+
+
+
+// ==================   Object   ================ //
+
+void *Mc_Clock_Array_New(size_t count)
+{
+    clock_array_t *p = malloc(sizeof(clock_array_t));
+    if (p == NULL)
+        return NULL;
+
+    // + 1: an empty set still gets valid columns
+    p->count = count;
+    p->timestamps = malloc(count * sizeof(int32_t) + 1);
+    p->seconds = malloc(count * sizeof(int32_t) + 1);
+    p->days = malloc(count * sizeof(int32_t) + 1);
+    p->years = malloc(count * sizeof(uint16_t) + 1);
+    p->months = malloc(count + 1);
+    p->mdays = malloc(count + 1);
+
+    if (p->timestamps == NULL || p->seconds == NULL || p->days == NULL
+        || p->years == NULL || p->months == NULL || p->mdays == NULL)
+    {
+        Mc_Clock_Array_Destroy(p);
+        return NULL;
+    }
+
+    Mc_Clock_Array_Set_All(p, 0);
+    return p;
+}// end Mc_Clock_Array_New
+
+void Mc_Clock_Array_Destroy(void *array)
+{
+    clock_array_t *a = array;
+
+    if (a == NULL)
+        return;
+
+    free(a->timestamps);
+    free(a->seconds);
+    free(a->days);
+    free(a->years);
+    free(a->months);
+    free(a->mdays);
+    free(a);
+}// end Mc_Clock_Array_Destroy
+
+size_t Mc_Clock_Array_Count(void *array)
+{
+    return ((clock_array_t *)array)->count;
+}// end Mc_Clock_Array_Count
+
+
+
+
+// ==================   Setters   ================ //
+
+void Mc_Clock_Array_Set_All(void *array, int32_t timestamp)
+{
+    clock_array_t *a = array;
+
+    if (a->count == 0)
+        return;
+
+    set_lane(a, 0, timestamp);
+    for (size_t i = 1; i < a->count; i++)
+    {
+        a->timestamps[i] = timestamp;
+        a->seconds[i] = a->seconds[0];
+        a->days[i] = a->days[0];
+        a->years[i] = a->years[0];
+        a->months[i] = a->months[0];
+        a->mdays[i] = a->mdays[0];
+    }
+}// end Mc_Clock_Array_Set_All
+
+void Mc_Clock_Array_Set_Timestamp(void *array, size_t index, int32_t timestamp)
+{
+    set_lane(array, index, timestamp);
+}// end Mc_Clock_Array_Set_Timestamp
+
+void Mc_Clock_Array_Set_Clock(void *array, size_t index, void *clock)
+{
+    set_lane(array, index, Mc_Clock_Get_Timestamp(clock));
+}// end Mc_Clock_Array_Set_Clock
+
+
+
+
+// ==================   Getters   ================ //
+
+int32_t Mc_Clock_Array_Get_Timestamp(void *array, size_t index)
+{
+    return ((clock_array_t *)array)->timestamps[index];
+}// end Mc_Clock_Array_Get_Timestamp
+
+void Mc_Clock_Array_Get_Clock(void *array, size_t index, void *clock)
+{
+    Mc_Clock_Set_Timestamp(clock, ((clock_array_t *)array)->timestamps[index]);
+}// end Mc_Clock_Array_Get_Clock
+
+const int32_t *Mc_Clock_Array_Timestamps(void *array)
+{
+    return ((clock_array_t *)array)->timestamps;
+}// end Mc_Clock_Array_Timestamps
+
+void Mc_Clock_Array_Gather(void *array, mc_clock_array_field_t field, const size_t *indices, size_t count, uint16_t *out)
+{
+    clock_array_t *a = array;
+
+    for (size_t i = 0; i < count; i++)
+        out[i] = field_of(a, (indices != NULL) ? indices[i] : i, field);
+}// end Mc_Clock_Array_Gather
+
+
+
+
+// ==================   Incrementers   ================ //
+
+void Mc_Clock_Array_Advance(void *array, int32_t delta)
+{
+    advance(array, NULL, delta);
+}// end Mc_Clock_Array_Advance
+
+void Mc_Clock_Array_Advance_Masked(void *array, const uint8_t *mask, int32_t delta)
+{
+    advance(array, mask, delta);
+}// end Mc_Clock_Array_Advance_Masked
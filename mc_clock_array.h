@@ -0,0 +1,145 @@
+/**
+ * @file mc_clock_array.h
+ * @brief Set of clocks stored as columns (timestamp, second of day, date) for bulk updates
+ *
+ * Advancing the set adds the delta to the timestamp and second of day columns. Dates are
+ * recomputed only for the clocks that crossed midnight; hour, minute and second are derived
+ * from the second of day when gathered.
+ *
+ * Example of usage:
+
+    void * devices = Mc_Clock_Array_New(1000000);
+    Mc_Clock_Array_Set_All(devices, Mc_Clock_Date_To_Timestamp(2024, 1, 1, 0, 0, 0));
+
+    // on every tick
+    Mc_Clock_Array_Advance(devices, 1);
+
+    // only the devices that are running
+    Mc_Clock_Array_Advance_Masked(devices, running, 60);
+
+    uint16_t hours[1000000];
+    Mc_Clock_Array_Gather(devices, MC_CLOCK_ARRAY_HOUR, NULL, 1000000, hours);
+ */
+
+#ifndef _MC_CLOCK_ARRAY_H
+#define _MC_CLOCK_ARRAY_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Fields that can be gathered from the set
+ */
+typedef enum
+{
+    MC_CLOCK_ARRAY_YEAR = 0,
+    MC_CLOCK_ARRAY_MONTH,
+    MC_CLOCK_ARRAY_DAY,
+    MC_CLOCK_ARRAY_HOUR,
+    MC_CLOCK_ARRAY_MINUTE,
+    MC_CLOCK_ARRAY_SECOND
+} mc_clock_array_field_t;
+
+
+
+
+// ==================   Object   ================ //
+
+/**
+ * @brief Creates a set of <count> clocks at timestamp 0 and returns a pointer to it
+ * @return Set object, NULL if out of memory
+ */
+void * Mc_Clock_Array_New(size_t count);
+
+/**
+ * @brief Free memory space of the set
+ *
+ */
+void Mc_Clock_Array_Destroy(void * array);
+
+/**
+ * @brief Get the number of clocks of the set
+ *
+ */
+size_t Mc_Clock_Array_Count(void * array);
+
+
+
+
+// ==================   Setters   ================ //
+
+/**
+ * @brief Set every clock of the set to the timestamp (date computed once)
+ *
+ */
+void Mc_Clock_Array_Set_All(void * array, int32_t timestamp);
+
+/**
+ * @brief Set one clock of the set to the timestamp
+ *
+ */
+void Mc_Clock_Array_Set_Timestamp(void * array, size_t index, int32_t timestamp);
+
+/**
+ * @brief Copy a clock object into the set
+ *
+ */
+void Mc_Clock_Array_Set_Clock(void * array, size_t index, void * clock);
+
+
+
+
+// ==================   Getters   ================ //
+
+/**
+ * @brief Get the timestamp of one clock of the set
+ *
+ */
+int32_t Mc_Clock_Array_Get_Timestamp(void * array, size_t index);
+
+/**
+ * @brief Copy one clock of the set into a clock object
+ *
+ */
+void Mc_Clock_Array_Get_Clock(void * array, size_t index, void * clock);
+
+/**
+ * @brief Get the timestamp column of the set (read only, valid until the set is destroyed)
+ *
+ */
+const int32_t * Mc_Clock_Array_Timestamps(void * array);
+
+/**
+ * @brief Copy a field of <count> clocks into out
+ * @param indices Clocks to read, NULL for clocks 0 to count - 1
+ */
+void Mc_Clock_Array_Gather(void * array, mc_clock_array_field_t field, const size_t * indices, size_t count, uint16_t * out);
+
+
+
+
+// ==================   Incrementers   ================ //
+
+/**
+ * @brief Add <delta> seconds to every clock of the set (negative goes back). Timestamps wrap as in
+ * Mc_Clock_Increment_Timestamp_Value().
+ */
+void Mc_Clock_Array_Advance(void * array, int32_t delta);
+
+/**
+ * @brief Add <delta> seconds to the clocks whose mask byte is not 0 (one byte per clock)
+ *
+ */
+void Mc_Clock_Array_Advance_Masked(void * array, const uint8_t * mask, int32_t delta);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _MC_CLOCK_ARRAY_H */
@@ -0,0 +1,500 @@
+/**
+ * @file mc_clock_business.c
+ */
+
+#include "mc_clock_business.h"
+#include "mc_clock.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define SECONDS_PER_DAY 86400LL
+#define YEARS           (MC_CLOCK_BUSINESS_LAST_YEAR - MC_CLOCK_BUSINESS_FIRST_YEAR + 1)
+// 366 days in 6 words, bit n = day n of the year (0 = 1/jan)
+#define YEAR_WORDS      6
+#define NO_DAY          INT32_MIN
+
+typedef enum
+{
+    HOLIDAY_DATE = 0,
+    HOLIDAY_FIXED,
+    HOLIDAY_RULE,
+    HOLIDAY_EASTER
+} holiday_kind_t;
+
+typedef struct
+{
+    uint8_t kind;
+    uint8_t month;
+    uint8_t day;
+    uint8_t weekday;
+    int8_t nth;
+    uint8_t observed;
+    uint16_t year;
+    int16_t offset;
+} holiday_t;
+
+typedef struct
+{
+    uint8_t weekend;
+    holiday_t *holidays;
+    size_t count;
+    size_t capacity;
+    uint8_t built[YEARS];
+    uint16_t totals[YEARS];             // business days of the year
+    uint64_t bits[YEARS][YEAR_WORDS];   // bit set = business day
+} business_t;
+
+
+// ##############################  PRIVATE FUNCTIONS  ################################# //
+
+static uint32_t bit_count(uint64_t word)
+{
+#if defined(__GNUC__)
+    return (uint32_t)__builtin_popcountll(word);
+#else
+    word = word - ((word >> 1) & 0x5555555555555555ULL);
+    word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+    word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (uint32_t)((word * 0x0101010101010101ULL) >> 56);
+#endif
+}// end bit_count
+
+// position of the lowest set bit (word is not 0)
+static uint32_t lowest_bit(uint64_t word)
+{
+#if defined(__GNUC__)
+    return (uint32_t)__builtin_ctzll(word);
+#else
+    return bit_count((word & (0 - word)) - 1);
+#endif
+}// end lowest_bit
+
+// position of the highest set bit (word is not 0)
+static uint32_t highest_bit(uint64_t word)
+{
+#if defined(__GNUC__)
+    return 63 - (uint32_t)__builtin_clzll(word);
+#else
+    uint32_t bit = 0;
+    while (word >>= 1)
+        bit++;
+    return bit;
+#endif
+}// end highest_bit
+
+// set bits in [from, to)
+static uint32_t count_bits(const uint64_t *words, uint32_t from, uint32_t to)
+{
+    if (from >= to)
+        return 0;
+
+    uint32_t first = from / 64;
+    uint32_t last = (to - 1) / 64;
+    uint64_t first_mask = ~0ULL << (from % 64);
+    uint64_t last_mask = ~0ULL >> (63 - (to - 1) % 64);
+
+    if (first == last)
+        return bit_count(words[first] & first_mask & last_mask);
+
+    uint32_t n = bit_count(words[first] & first_mask);
+    for (uint32_t w = first + 1; w < last; w++)
+        n += bit_count(words[w]);
+
+    return n + bit_count(words[last] & last_mask);
+}// end count_bits
+
+// position of the nth set bit at or after <from> (there are at least n)
+static uint32_t select_forward(const uint64_t *words, uint32_t from, uint32_t n)
+{
+    uint32_t w = from / 64;
+    uint64_t word = words[w] & (~0ULL << (from % 64));
+
+    // whole words first
+    for (uint32_t c = bit_count(word); n > c; c = bit_count(word))
+    {
+        n -= c;
+        word = words[++w];
+    }
+
+    while (--n)
+        word &= word - 1;
+
+    return w * 64 + lowest_bit(word);
+}// end select_forward
+
+// position of the nth set bit before <to>, going back (there are at least n)
+static uint32_t select_backward(const uint64_t *words, uint32_t to, uint32_t n)
+{
+    uint32_t w = (to - 1) / 64;
+    uint64_t word = words[w] & (~0ULL >> (63 - (to - 1) % 64));
+
+    for (uint32_t c = bit_count(word); n > c; c = bit_count(word))
+    {
+        n -= c;
+        word = words[--w];
+    }
+
+    while (--n)
+        word &= ~(1ULL << highest_bit(word));
+
+    return w * 64 + highest_bit(word);
+}// end select_backward
+
+// day number of gregorian easter sunday (anonymous gregorian algorithm)
+static int32_t easter_of(uint16_t year)
+{
+    int a = year % 19;
+    int b = year / 100;
+    int c = year % 100;
+    int d = b / 4;
+    int e = b % 4;
+    int f = (b + 8) / 25;
+    int g = (b - f + 1) / 3;
+    int h = (19 * a + b - d - g + 15) % 30;
+    int i = c / 4;
+    int k = c % 4;
+    int l = (32 + 2 * e + 2 * i - h - k) % 7;
+    int m = (a + 11 * h + 22 * l) / 451;
+    int month = (h + l - 7 * m + 114) / 31;
+    int day = (h + l - 7 * m + 114) % 31 + 1;
+
+    return Mc_Clock_Date_To_Days(year, (uint8_t)month, (uint8_t)day);
+}// end easter_of
+
+// day number of the holiday in the year, NO_DAY if it doesn't happen that year
+static int32_t holiday_day(const holiday_t *h, uint16_t year)
+{
+    int32_t days;
+
+    switch (h->kind)
+    {
+    case HOLIDAY_DATE:
+        return (h->year == year) ? Mc_Clock_Date_To_Days(year, h->month, h->day) : NO_DAY;
+
+    case HOLIDAY_FIXED:
+        if (h->day > Mc_Clock_Days_In_Month(h->month, year))
+            return NO_DAY;
+
+        days = Mc_Clock_Date_To_Days(year, h->month, h->day);
+        if (h->observed && Mc_Clock_Days_To_Weekday(days) == 6)
+            days -= 1;
+        else if (h->observed && Mc_Clock_Days_To_Weekday(days) == 0)
+            days += 1;
+        return days;
+
+    case HOLIDAY_RULE:
+        if (h->nth > 0)
+        {
+            days = Mc_Clock_Date_To_Days(year, h->month, 1);
+            days += (h->weekday - Mc_Clock_Days_To_Weekday(days) + 7) % 7 + (h->nth - 1) * 7;
+        }
+        else
+        {
+            days = Mc_Clock_Date_To_Days(year, h->month, Mc_Clock_Days_In_Month(h->month, year));
+            days -= (Mc_Clock_Days_To_Weekday(days) - h->weekday + 7) % 7 + (-h->nth - 1) * 7;
+        }
+
+        // 5th weekday missing from the month
+        if (days < Mc_Clock_Date_To_Days(year, h->month, 1)
+            || days > Mc_Clock_Date_To_Days(year, h->month, Mc_Clock_Days_In_Month(h->month, year)))
+            return NO_DAY;
+        return days;
+
+    default:
+        return easter_of(year) + h->offset;
+    }
+}// end holiday_day
+
+static void build_year(business_t *b, uint16_t year)
+{
+    size_t y = year - MC_CLOCK_BUSINESS_FIRST_YEAR;
+    uint64_t *words = b->bits[y];
+    int32_t start = Mc_Clock_Date_To_Days(year, 1, 1);
+    int32_t length = 365 + Mc_Clock_Is_Leap_Year(year);
+
+    memset(words, 0, sizeof(b->bits[y]));
+    for (int32_t d = 0; d < length; d++)
+    {
+        if (!((b->weekend >> Mc_Clock_Days_To_Weekday(start + d)) & 1))
+            words[d / 64] |= 1ULL << (d % 64);
+    }
+
+    // observed and easter days can move a holiday of the next or previous year into this one
+    for (size_t i = 0; i < b->count; i++)
+    {
+        for (int k = -1; k <= 1; k++)
+        {
+            int32_t d = holiday_day(&b->holidays[i], (uint16_t)(year + k));
+            if (d != NO_DAY && d >= start && d < start + length)
+                words[(d - start) / 64] &= ~(1ULL << ((d - start) % 64));
+        }
+    }
+
+    b->totals[y] = (uint16_t)count_bits(words, 0, (uint32_t)length);
+    b->built[y] = 1;
+}// end build_year
+
+static const uint64_t *year_bits(business_t *b, uint16_t year)
+{
+    if (!b->built[year - MC_CLOCK_BUSINESS_FIRST_YEAR])
+        build_year(b, year);
+
+    return b->bits[year - MC_CLOCK_BUSINESS_FIRST_YEAR];
+}// end year_bits
+
+static uint32_t year_total(business_t *b, uint16_t year)
+{
+    year_bits(b, year);
+    return b->totals[year - MC_CLOCK_BUSINESS_FIRST_YEAR];
+}// end year_total
+
+static uint32_t year_length(uint16_t year)
+{
+    return 365 + Mc_Clock_Is_Leap_Year(year);
+}// end year_length
+
+// year and day of year of a day number. 0 if out of the calendar years
+static uint8_t locate(int32_t days, uint16_t *year, uint32_t *offset)
+{
+    if (days < Mc_Clock_Date_To_Days(MC_CLOCK_BUSINESS_FIRST_YEAR, 1, 1)
+        || days >= Mc_Clock_Date_To_Days(MC_CLOCK_BUSINESS_LAST_YEAR + 1, 1, 1))
+        return 0;
+
+    // estimate, then correct by at most a year
+    int32_t y = 1970 + (int32_t)(((int64_t)days * 400) / 146097);
+    if (y < MC_CLOCK_BUSINESS_FIRST_YEAR)
+        y = MC_CLOCK_BUSINESS_FIRST_YEAR;
+    if (y > MC_CLOCK_BUSINESS_LAST_YEAR)
+        y = MC_CLOCK_BUSINESS_LAST_YEAR;
+
+    while (Mc_Clock_Date_To_Days((uint16_t)y, 1, 1) > days)
+        y--;
+    while (y < MC_CLOCK_BUSINESS_LAST_YEAR && Mc_Clock_Date_To_Days((uint16_t)(y + 1), 1, 1) <= days)
+        y++;
+
+    *year = (uint16_t)y;
+    *offset = (uint32_t)(days - Mc_Clock_Date_To_Days((uint16_t)y, 1, 1));
+    return 1;
+}// end locate
+
+// business days in [from, to), from <= to
+static int32_t count_days(business_t *b, int32_t from, int32_t to)
+{
+    uint16_t from_year;
+    uint16_t to_year;
+    uint32_t from_offset;
+    uint32_t to_offset;
+
+    // clock dates are always in the calendar years
+    locate(from, &from_year, &from_offset);
+    locate(to, &to_year, &to_offset);
+
+    if (from_year == to_year)
+        return (int32_t)count_bits(year_bits(b, from_year), from_offset, to_offset);
+
+    int32_t n = (int32_t)count_bits(year_bits(b, from_year), from_offset, year_length(from_year));
+    for (uint16_t y = from_year + 1; y < to_year; y++)
+        n += (int32_t)year_total(b, y);
+
+    return n + (int32_t)count_bits(year_bits(b, to_year), 0, to_offset);
+}// end count_days
+
+// day number of the nth business day after <from> (before it if n < 0), NO_DAY if out of the calendar years
+static int32_t find_day(business_t *b, int32_t from, int32_t n)
+{
+    uint16_t year;
+    uint32_t offset;
+
+    if (!locate(from, &year, &offset))
+        return NO_DAY;
+
+    if (n > 0)
+    {
+        uint32_t remaining = (uint32_t)n;
+        uint32_t start = offset + 1;
+
+        // whole years by their total
+        while (1)
+        {
+            uint32_t available = (start == 0) ? year_total(b, year)
+                                              : count_bits(year_bits(b, year), start, year_length(year));
+            if (remaining <= available)
+                break;
+
+            remaining -= available;
+            if (year == MC_CLOCK_BUSINESS_LAST_YEAR)
+                return NO_DAY;
+            year++;
+            start = 0;
+        }
+
+        return Mc_Clock_Date_To_Days(year, 1, 1) + (int32_t)select_forward(year_bits(b, year), start, remaining);
+    }
+
+    uint32_t remaining = 0 - (uint32_t)n;
+    uint32_t end = offset;
+
+    while (1)
+    {
+        uint32_t available = (end == year_length(year)) ? year_total(b, year) : count_bits(year_bits(b, year), 0, end);
+        if (remaining <= available)
+            break;
+
+        remaining -= available;
+        if (year == MC_CLOCK_BUSINESS_FIRST_YEAR)
+            return NO_DAY;
+        year--;
+        end = year_length(year);
+    }
+
+    return Mc_Clock_Date_To_Days(year, 1, 1) + (int32_t)select_backward(year_bits(b, year), end, remaining);
+}// end find_day
+
+static int add_holiday(business_t *b, const holiday_t *h)
+{
+    if (b->count == b->capacity)
+    {
+        size_t capacity = (b->capacity == 0) ? 8 : b->capacity * 2;
+        holiday_t *holidays = realloc(b->holidays, capacity * sizeof(holiday_t));
+        if (holidays == NULL)
+            return -1;
+
+        b->holidays = holidays;
+        b->capacity = capacity;
+    }
+
+    b->holidays[b->count++] = *h;
+
+    // bitmaps are rebuilt on next use
+    memset(b->built, 0, sizeof(b->built));
+    return 0;
+}// end add_holiday
+
+
+
+
+// ##############################  PUBLIC FUNCTIONS  ################################# //
+
+
+
+
+// ==================   Object   ================ //
+
+void *Mc_Clock_Business_New(uint8_t weekend)
+{
+    business_t *p = malloc(sizeof(business_t));
+    if (p == NULL)
+        return NULL;
+
+    p->weekend = weekend & 0x7F;
+    p->holidays = NULL;
+    p->count = 0;
+    p->capacity = 0;
+    memset(p->built, 0, sizeof(p->built));
+
+    return p;
+}// end Mc_Clock_Business_New
+
+void Mc_Clock_Business_Destroy(void *calendar)
+{
+    business_t *b = calendar;
+
+    if (b == NULL)
+        return;
+
+    free(b->holidays);
+    free(b);
+}// end Mc_Clock_Business_Destroy
+
+
+
+
+// ==================   Holidays   ================ //
+
+int Mc_Clock_Business_Add_Holiday(void *calendar, uint16_t year, uint8_t month, uint8_t day)
+{
+    holiday_t h = {HOLIDAY_DATE, month, day, 0, 0, 0, year, 0};
+
+    if (year < MC_CLOCK_BUSINESS_FIRST_YEAR || year > MC_CLOCK_BUSINESS_LAST_YEAR
+        || month < 1 || month > 12 || day < 1 || day > Mc_Clock_Days_In_Month(month, year))
+        return -1;
+
+    return add_holiday(calendar, &h);
+}// end Mc_Clock_Business_Add_Holiday
+
+int Mc_Clock_Business_Add_Fixed(void *calendar, uint8_t month, uint8_t day, uint8_t observed)
+{
+    holiday_t h = {HOLIDAY_FIXED, month, day, 0, 0, observed != 0, 0, 0};
+
+    // any leap year: 29/feb is valid
+    if (month < 1 || month > 12 || day < 1 || day > Mc_Clock_Days_In_Month(month, 2000))
+        return -1;
+
+    return add_holiday(calendar, &h);
+}// end Mc_Clock_Business_Add_Fixed
+
+int Mc_Clock_Business_Add_Rule(void *calendar, uint8_t month, uint8_t weekday, int8_t nth)
+{
+    holiday_t h = {HOLIDAY_RULE, month, 0, weekday, nth, 0, 0, 0};
+
+    if (month < 1 || month > 12 || weekday > 6 || nth == 0 || nth > 5 || nth < -5)
+        return -1;
+
+    return add_holiday(calendar, &h);
+}// end Mc_Clock_Business_Add_Rule
+
+int Mc_Clock_Business_Add_Easter(void *calendar, int16_t offset)
+{
+    holiday_t h = {HOLIDAY_EASTER, 0, 0, 0, 0, 0, 0, offset};
+
+    // years are built from the holidays of the year before and after: the day must stay within them
+    if (offset < -MC_CLOCK_BUSINESS_EASTER_MAX_OFFSET || offset > MC_CLOCK_BUSINESS_EASTER_MAX_OFFSET)
+        return -1;
+
+    return add_holiday(calendar, &h);
+}// end Mc_Clock_Business_Add_Easter
+
+
+
+
+// ==================   Queries   ================ //
+
+uint8_t Mc_Clock_Business_Is_Business_Day(void *calendar, void *clock)
+{
+    uint16_t year;
+    uint32_t offset;
+
+    if (!locate(Mc_Clock_Timestamp_To_Days(Mc_Clock_Get_Timestamp(clock)), &year, &offset))
+        return 0;
+
+    return (year_bits(calendar, year)[offset / 64] >> (offset % 64)) & 1;
+}// end Mc_Clock_Business_Is_Business_Day
+
+int32_t Mc_Clock_Business_Count(void *calendar, void *from, void *to)
+{
+    int32_t from_day = Mc_Clock_Timestamp_To_Days(Mc_Clock_Get_Timestamp(from));
+    int32_t to_day = Mc_Clock_Timestamp_To_Days(Mc_Clock_Get_Timestamp(to));
+
+    if (to_day < from_day)
+        return -count_days(calendar, to_day, from_day);
+
+    return count_days(calendar, from_day, to_day);
+}// end Mc_Clock_Business_Count
+
+int Mc_Clock_Business_Add_Days(void *calendar, void *clock, int32_t days)
+{
+    if (days == 0)
+        return 0;
+
+    int32_t from = Mc_Clock_Timestamp_To_Days(Mc_Clock_Get_Timestamp(clock));
+    int32_t to = find_day(calendar, from, days);
+    if (to == NO_DAY)
+        return -1;
+
+    int64_t timestamp = Mc_Clock_Get_Timestamp(clock) + (int64_t)(to - from) * SECONDS_PER_DAY;
+    if (timestamp < INT32_MIN || timestamp > INT32_MAX)
+        return -1;
+
+    Mc_Clock_Set_Timestamp(clock, (int32_t)timestamp);
+    return 0;
+}// end Mc_Clock_Business_Add_Days
@@ -0,0 +1,129 @@
+/**
+ * @file mc_clock_business.h
+ * @brief Business-day calendar: weekend mask and holidays, with one bitmap of business days per year
+ *
+ * Bitmaps are built on first use of a year (1901-2038) and rebuilt after a holiday is added.
+ * Queries count bits with popcount, a word (64 days) at a time; whole years use a stored total.
+ *
+ * Example of usage:
+
+    void * calendar = Mc_Clock_Business_New(MC_CLOCK_BUSINESS_WEEKEND_SAT_SUN);
+
+    Mc_Clock_Business_Add_Fixed(calendar, 1, 1, 1);     // new year's day, observed on friday/monday
+    Mc_Clock_Business_Add_Rule(calendar, 5, 1, -1);     // last monday of may
+    Mc_Clock_Business_Add_Easter(calendar, -2);         // good friday
+    Mc_Clock_Business_Add_Holiday(calendar, 2024, 11, 29);
+
+    // SLA due date: 5 business days after the ticket was opened
+    Mc_Clock_Business_Add_Days(calendar, due, 5);
+
+    int32_t days = Mc_Clock_Business_Count(calendar, opened, closed);
+ */
+
+#ifndef _MC_CLOCK_BUSINESS_H
+#define _MC_CLOCK_BUSINESS_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+/**
+ * @brief Weekend masks: bit n set = weekday n is not a business day (0 = sunday, 6 = saturday)
+ */
+#define MC_CLOCK_BUSINESS_WEEKEND_NONE      0x00
+#define MC_CLOCK_BUSINESS_WEEKEND_SAT_SUN   0x41
+#define MC_CLOCK_BUSINESS_WEEKEND_FRI_SAT   0x60
+
+/**
+ * @brief Years covered by the calendar (timestamp range)
+ */
+#define MC_CLOCK_BUSINESS_FIRST_YEAR        1901
+#define MC_CLOCK_BUSINESS_LAST_YEAR         2038
+
+/**
+ * @brief Largest offset (days) from easter accepted by Mc_Clock_Business_Add_Easter()
+ */
+#define MC_CLOCK_BUSINESS_EASTER_MAX_OFFSET 250
+
+
+
+
+// ==================   Object   ================ //
+
+/**
+ * @brief Creates a business calendar without holidays and returns a pointer to it
+ * @param weekend Weekend mask (MC_CLOCK_BUSINESS_WEEKEND_SAT_SUN...)
+ * @return Calendar object, NULL if out of memory
+ */
+void * Mc_Clock_Business_New(uint8_t weekend);
+
+/**
+ * @brief Free memory space of the calendar
+ *
+ */
+void Mc_Clock_Business_Destroy(void * calendar);
+
+
+
+
+// ==================   Holidays   ================ //
+
+/**
+ * @brief Add a holiday on one date
+ * @return 0 on success, -1 if date is not valid or out of memory
+ */
+int Mc_Clock_Business_Add_Holiday(void * calendar, uint16_t year, uint8_t month, uint8_t day);
+
+/**
+ * @brief Add a holiday on the same date every year (29/feb only on leap years)
+ * @param observed If not 0, a holiday on saturday is observed on friday and on sunday on monday
+ * @return 0 on success, -1 if date is not valid or out of memory
+ */
+int Mc_Clock_Business_Add_Fixed(void * calendar, uint8_t month, uint8_t day, uint8_t observed);
+
+/**
+ * @brief Add a holiday on the nth weekday of a month every year
+ * @param weekday 0 = sunday to 6 = saturday
+ * @param nth 1 to 5 from the start of the month, -1 to -5 from the end (-1 = last). Skipped on years without it.
+ * @return 0 on success, -1 if a parameter is not valid or out of memory
+ */
+int Mc_Clock_Business_Add_Rule(void * calendar, uint8_t month, uint8_t weekday, int8_t nth);
+
+/**
+ * @brief Add a holiday <offset> days from (gregorian) easter sunday every year (-2 = good friday, 1 = easter monday)
+ * @return 0 on success, -1 if |offset| > MC_CLOCK_BUSINESS_EASTER_MAX_OFFSET or out of memory
+ */
+int Mc_Clock_Business_Add_Easter(void * calendar, int16_t offset);
+
+
+
+
+// ==================   Queries   ================ //
+
+/**
+ * @brief Verify if the clock date is a business day
+ *
+ */
+uint8_t Mc_Clock_Business_Is_Business_Day(void * calendar, void * clock);
+
+/**
+ * @brief Count business days from the date of clock <from> (included) to the date of clock <to> (excluded)
+ * @return Number of business days, negative if <to> is before <from>
+ */
+int32_t Mc_Clock_Business_Count(void * calendar, void * from, void * to);
+
+/**
+ * @brief Move clock to the <days>th business day after its date (before it if negative), keeping the time of day
+ * @return 0 on success, -1 if the result is out of the calendar years (clock is not changed)
+ */
+int Mc_Clock_Business_Add_Days(void * calendar, void * clock, int32_t days);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _MC_CLOCK_BUSINESS_H */
@@ -0,0 +1,539 @@
+/**
+ * @file mc_clock_cron.c
+ */
+
+#include "mc_clock_cron.h"
+#include "mc_clock.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define CRON_FIELDS 5
+
+// latest year searched by Mc_Clock_Cron_Next (end of int32_t timestamps)
+#define CRON_LAST_YEAR 2038
+
+typedef struct
+{
+    uint64_t minutes;   // bits 0-59
+    uint32_t hours;     // bits 0-23
+    uint32_t days;      // bits 1-31
+    uint16_t months;    // bits 1-12
+    uint8_t weekdays;   // bits 0-6, 0 = sunday
+    uint8_t days_star;      // day-of-month field starts with '*'
+    uint8_t weekdays_star;  // day-of-week field starts with '*'
+} cron_t;
+
+typedef struct
+{
+    int32_t next;
+    void *cron;
+    mc_clock_cron_callback_t callback;
+    void *context;
+} cron_entry_t;
+
+typedef struct
+{
+    cron_entry_t *heap;
+    size_t count;
+    size_t capacity;
+} cron_scheduler_t;
+
+typedef struct
+{
+    uint8_t min;
+    uint8_t max;
+    const char *const *names;  // 3 letter names of min..max, or NULL
+} cron_field_t;
+
+static const char *const month_names[12] = {"JAN", "FEB", "MAR", "APR", "MAY", "JUN",
+                                            "JUL", "AUG", "SEP", "OCT", "NOV", "DEC"};
+static const char *const weekday_names[8] = {"SUN", "MON", "TUE", "WED", "THU", "FRI", "SAT", "SUN"};
+
+static const cron_field_t cron_fields[CRON_FIELDS] = {
+    {0, 59, NULL},
+    {0, 23, NULL},
+    {1, 31, NULL},
+    {1, 12, month_names},
+    {0, 7, weekday_names},
+};
+
+static const struct
+{
+    const char *name;
+    const char *expression;
+} cron_macros[] = {
+    {"@yearly", "0 0 1 1 *"},
+    {"@annually", "0 0 1 1 *"},
+    {"@monthly", "0 0 1 * *"},
+    {"@weekly", "0 0 * * 0"},
+    {"@daily", "0 0 * * *"},
+    {"@midnight", "0 0 * * *"},
+    {"@hourly", "0 * * * *"},
+};
+
+
+// ##############################  PRIVATE FUNCTIONS  ################################# //
+
+static int lowest_bit(uint64_t mask)
+{
+#if defined(__GNUC__)
+    return __builtin_ctzll(mask);
+#else
+    int bit = 0;
+    while ((mask & 1) == 0)
+    {
+        mask >>= 1;
+        bit++;
+    }
+    return bit;
+#endif
+}// end lowest_bit
+
+// read a number or a 3 letter name. 0 if there is none
+static uint8_t parse_value(const char **text, const cron_field_t *field, int *value)
+{
+    const char *p = *text;
+
+    if (*p >= '0' && *p <= '9')
+    {
+        int v = 0;
+        while (*p >= '0' && *p <= '9' && v <= 255)
+            v = v * 10 + (*p++ - '0');
+        *text = p;
+        *value = v;
+        return 1;
+    }
+
+    if (field->names == NULL)
+        return 0;
+
+    for (int i = 0; i <= field->max - field->min; i++)
+    {
+        const char *name = field->names[i];
+        uint8_t match = 1;
+
+        for (int c = 0; c < 3 && match; c++)
+            match = (p[c] & ~0x20) == name[c];
+
+        if (match)
+        {
+            *text = p + 3;
+            *value = field->min + i;
+            return 1;
+        }
+    }
+
+    return 0;
+}// end parse_value
+
+// parse one field into bits min..max. -1 if not valid
+static int parse_field(const char **text, const cron_field_t *field, uint64_t *bits)
+{
+    const char *p = *text;
+
+    *bits = 0;
+    while (1)
+    {
+        int first;
+        int last;
+        int step = 1;
+        uint8_t single = 0;
+
+        if (*p == '*')
+        {
+            first = field->min;
+            last = field->max;
+            p++;
+        }
+        else
+        {
+            if (!parse_value(&p, field, &first))
+                return -1;
+            last = first;
+
+            if (*p == '-')
+            {
+                p++;
+                if (!parse_value(&p, field, &last))
+                    return -1;
+            }
+            else
+            {
+                single = 1;
+            }
+        }
+
+        if (*p == '/')
+        {
+            p++;
+            if (!parse_value(&p, &cron_fields[0], &step) || step == 0)
+                return -1;
+
+            // "N/step": from N to max
+            if (single)
+                last = field->max;
+        }
+
+        if (first < field->min || last > field->max || first > last)
+            return -1;
+
+        for (int v = first; v <= last; v += step)
+            *bits |= 1ULL << v;
+
+        if (*p != ',')
+            break;
+        p++;
+    }
+
+    if (*p != ' ' && *p != '\t' && *p != '\0')
+        return -1;
+
+    *text = p;
+    return 0;
+}// end parse_field
+
+static int cron_compile(cron_t *cron, const char *expression)
+{
+    const char *p = expression;
+    uint64_t bits[CRON_FIELDS];
+    uint8_t star[CRON_FIELDS];
+
+    for (int f = 0; f < CRON_FIELDS; f++)
+    {
+        while (*p == ' ' || *p == '\t')
+            p++;
+
+        star[f] = (*p == '*');
+        if (parse_field(&p, &cron_fields[f], &bits[f]) != 0)
+            return -1;
+    }
+
+    while (*p == ' ' || *p == '\t')
+        p++;
+    if (*p != '\0')
+        return -1;
+
+    cron->minutes = bits[0];
+    cron->hours = (uint32_t)bits[1];
+    cron->days = (uint32_t)bits[2];
+    cron->months = (uint16_t)bits[3];
+    // 7 is sunday too
+    cron->weekdays = (uint8_t)((bits[4] | (bits[4] >> 7)) & 0x7F);
+    cron->days_star = star[2];
+    cron->weekdays_star = star[4];
+
+    return 0;
+}// end cron_compile
+
+// matching days of a month, bits 1..days in month
+static uint32_t cron_month_days(const cron_t *cron, int32_t year, int month)
+{
+    uint8_t dim = Mc_Clock_Days_In_Month((uint8_t)month, (uint16_t)year);
+    uint32_t valid = (uint32_t)((1ULL << (dim + 1)) - 2);
+
+    // weekday of day 1, then weekly pattern repeated over 6 weeks and aligned to day 1
+    int32_t weekday = Mc_Clock_Days_To_Weekday(Mc_Clock_Date_To_Days((uint16_t)year, (uint8_t)month, 1));
+    uint64_t weeks = (uint64_t)cron->weekdays * 0x0810204081ULL;
+    uint32_t by_weekday = (uint32_t)((weeks >> weekday) << 1);
+
+    uint32_t days;
+    if (cron->days_star && cron->weekdays_star)
+        days = valid;
+    else if (cron->days_star)
+        days = by_weekday;
+    else if (cron->weekdays_star)
+        days = cron->days;
+    else
+        days = cron->days | by_weekday;
+
+    return days & valid;
+}// end cron_month_days
+
+// first match at or after the given fields (which may overflow their range: minute 60, hour 24...)
+static int32_t cron_next(const cron_t *cron, int32_t year, int month, int day, int hour, int minute)
+{
+    while (year <= CRON_LAST_YEAR)
+    {
+        uint64_t months = month <= 12 ? (cron->months & (~0ULL << month)) : 0;
+        if (months == 0)
+        {
+            year++;
+            month = 1;
+            day = 1;
+            hour = 0;
+            minute = 0;
+            continue;
+        }
+        if (lowest_bit(months) != month)
+        {
+            month = lowest_bit(months);
+            day = 1;
+            hour = 0;
+            minute = 0;
+        }
+
+        uint64_t days = cron_month_days(cron, year, month) & (~0ULL << day);
+        if (days == 0)
+        {
+            month++;
+            day = 1;
+            hour = 0;
+            minute = 0;
+            continue;
+        }
+        if (lowest_bit(days) != day)
+        {
+            day = lowest_bit(days);
+            hour = 0;
+            minute = 0;
+        }
+
+        uint64_t hours = cron->hours & (~0ULL << hour);
+        if (hours == 0)
+        {
+            day++;
+            hour = 0;
+            minute = 0;
+            continue;
+        }
+        if (lowest_bit(hours) != hour)
+        {
+            hour = lowest_bit(hours);
+            minute = 0;
+        }
+
+        uint64_t minutes = cron->minutes & (~0ULL << minute);
+        if (minutes == 0)
+        {
+            hour++;
+            minute = 0;
+            continue;
+        }
+        minute = lowest_bit(minutes);
+
+        int64_t timestamp = (int64_t)Mc_Clock_Date_To_Days((uint16_t)year, (uint8_t)month, (uint8_t)day) * 86400LL
+                          + hour * 3600 + minute * 60;
+
+        return (timestamp > INT32_MAX) ? INT32_MIN : (int32_t)timestamp;
+    }
+
+    return INT32_MIN;
+}// end cron_next
+
+static int32_t cron_next_after(const cron_t *cron, void *clock)
+{
+    return cron_next(cron, Mc_Clock_Get_Year(clock), Mc_Clock_Get_Month(clock), Mc_Clock_Get_Day(clock),
+                     Mc_Clock_Get_Hour(clock), Mc_Clock_Get_Minute(clock) + 1);
+}// end cron_next_after
+
+static void heap_swap(cron_entry_t *heap, size_t a, size_t b)
+{
+    cron_entry_t tmp = heap[a];
+    heap[a] = heap[b];
+    heap[b] = tmp;
+}// end heap_swap
+
+static void heap_sift_up(cron_entry_t *heap, size_t i)
+{
+    while (i > 0 && heap[(i - 1) / 2].next > heap[i].next)
+    {
+        heap_swap(heap, i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+}// end heap_sift_up
+
+static void heap_sift_down(cron_entry_t *heap, size_t count, size_t i)
+{
+    while (1)
+    {
+        size_t smallest = i;
+        size_t left = 2 * i + 1;
+        size_t right = left + 1;
+
+        if (left < count && heap[left].next < heap[smallest].next)
+            smallest = left;
+        if (right < count && heap[right].next < heap[smallest].next)
+            smallest = right;
+        if (smallest == i)
+            return;
+
+        heap_swap(heap, i, smallest);
+        i = smallest;
+    }
+}// end heap_sift_down
+
+static void heap_remove(cron_scheduler_t *s, size_t i)
+{
+    s->count--;
+    if (i == s->count)
+        return;
+
+    s->heap[i] = s->heap[s->count];
+    heap_sift_down(s->heap, s->count, i);
+    heap_sift_up(s->heap, i);
+}// end heap_remove
+
+
+
+
+// ##############################  PUBLIC FUNCTIONS  ################################# //
+
+
+
+
+// ==================   Expression   ================ //
+
+void *Mc_Clock_Cron_New(const char *expression)
+{
+    cron_t *p = malloc(sizeof(cron_t));
+    if (p == NULL)
+        return NULL;
+
+    for (size_t i = 0; i < sizeof(cron_macros) / sizeof(cron_macros[0]); i++)
+    {
+        if (strcmp(expression, cron_macros[i].name) == 0)
+        {
+            expression = cron_macros[i].expression;
+            break;
+        }
+    }
+
+    if (cron_compile(p, expression) != 0)
+    {
+        free(p);
+        return NULL;
+    }
+
+    return p;
+}// end Mc_Clock_Cron_New
+
+void Mc_Clock_Cron_Destroy(void *cron)
+{
+    free((cron_t *)cron);
+}// end Mc_Clock_Cron_Destroy
+
+uint8_t Mc_Clock_Cron_Match(void *cron, void *clock)
+{
+    cron_t *_cron = cron;
+
+    if (!(_cron->minutes & (1ULL << Mc_Clock_Get_Minute(clock))) || !(_cron->hours & (1UL << Mc_Clock_Get_Hour(clock))))
+        return 0;
+
+    if (!(_cron->months & (1U << Mc_Clock_Get_Month(clock))))
+        return 0;
+
+    uint32_t days = cron_month_days(_cron, Mc_Clock_Get_Year(clock), Mc_Clock_Get_Month(clock));
+    return (days >> Mc_Clock_Get_Day(clock)) & 1;
+}// end Mc_Clock_Cron_Match
+
+int32_t Mc_Clock_Cron_Next(void *cron, void *clock)
+{
+    return cron_next_after(cron, clock);
+}// end Mc_Clock_Cron_Next
+
+
+
+
+// ==================   Scheduler   ================ //
+
+void *Mc_Clock_Cron_Scheduler_New(void)
+{
+    cron_scheduler_t *p = malloc(sizeof(cron_scheduler_t));
+    if (p == NULL)
+        return NULL;
+
+    p->heap = NULL;
+    p->count = 0;
+    p->capacity = 0;
+
+    return p;
+}// end Mc_Clock_Cron_Scheduler_New
+
+void Mc_Clock_Cron_Scheduler_Destroy(void *scheduler)
+{
+    cron_scheduler_t *s = scheduler;
+
+    if (s == NULL)
+        return;
+
+    free(s->heap);
+    free(s);
+}// end Mc_Clock_Cron_Scheduler_Destroy
+
+int Mc_Clock_Cron_Scheduler_Add(void *scheduler, void *cron, mc_clock_cron_callback_t callback, void *context, void *clock)
+{
+    cron_scheduler_t *s = scheduler;
+
+    int32_t next = cron_next_after(cron, clock);
+    if (next == INT32_MIN)
+        return -1;
+
+    if (s->count == s->capacity)
+    {
+        size_t capacity = s->capacity ? s->capacity * 2 : 16;
+        cron_entry_t *heap = realloc(s->heap, capacity * sizeof(cron_entry_t));
+        if (heap == NULL)
+            return -1;
+
+        s->heap = heap;
+        s->capacity = capacity;
+    }
+
+    cron_entry_t *entry = &s->heap[s->count];
+    entry->next = next;
+    entry->cron = cron;
+    entry->callback = callback;
+    entry->context = context;
+
+    heap_sift_up(s->heap, s->count);
+    s->count++;
+
+    return 0;
+}// end Mc_Clock_Cron_Scheduler_Add
+
+int Mc_Clock_Cron_Scheduler_Remove(void *scheduler, void *cron)
+{
+    cron_scheduler_t *s = scheduler;
+
+    for (size_t i = 0; i < s->count; i++)
+    {
+        if (s->heap[i].cron == cron)
+        {
+            heap_remove(s, i);
+            return 0;
+        }
+    }
+
+    return -1;
+}// end Mc_Clock_Cron_Scheduler_Remove
+
+int32_t Mc_Clock_Cron_Scheduler_Peek(void *scheduler)
+{
+    cron_scheduler_t *s = scheduler;
+    return s->count ? s->heap[0].next : INT32_MIN;
+}// end Mc_Clock_Cron_Scheduler_Peek
+
+size_t Mc_Clock_Cron_Scheduler_Run(void *scheduler, void *clock)
+{
+    cron_scheduler_t *s = scheduler;
+    int32_t now = Mc_Clock_Get_Timestamp(clock);
+    size_t calls = 0;
+
+    // callbacks must not add or remove entries of this scheduler
+    while (s->count > 0 && s->heap[0].next <= now)
+    {
+        cron_entry_t *entry = &s->heap[0];
+
+        if (entry->callback != NULL)
+            entry->callback(entry->cron, entry->context, entry->next);
+        calls++;
+
+        entry->next = cron_next_after(entry->cron, clock);
+        if (entry->next == INT32_MIN)
+            heap_remove(s, 0);
+        else
+            heap_sift_down(s->heap, s->count, 0);
+    }
+
+    return calls;
+}// end Mc_Clock_Cron_Scheduler_Run
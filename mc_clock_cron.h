@@ -0,0 +1,116 @@
+/**
+ * @file mc_clock_cron.h
+ * @brief Cron expressions compiled to bitmasks, next fire time and scheduler
+ *
+ * Expression: "minute hour day-of-month month day-of-week". Each field is a list of
+ * '*', N or N-M, with an optional "/step". Months accept JAN-DEC, weekdays SUN-SAT (0 or 7 = sunday).
+ * When both day fields are restricted, a day matches if either one matches (as Vixie cron).
+ * Macros: @yearly, @annually, @monthly, @weekly, @daily, @midnight, @hourly.
+ *
+ * Example of usage:
+
+    void * cron = Mc_Clock_Cron_New("0 3 * * 1-5");
+
+    int32_t next = Mc_Clock_Cron_Next(cron, clock);
+
+    void * scheduler = Mc_Clock_Cron_Scheduler_New();
+    Mc_Clock_Cron_Scheduler_Add(scheduler, cron, nightly_backup, NULL, clock);
+
+    // on every tick
+    Mc_Clock_Cron_Scheduler_Run(scheduler, clock);
+ */
+
+#ifndef _MC_CLOCK_CRON_H
+#define _MC_CLOCK_CRON_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Called by Mc_Clock_Cron_Scheduler_Run() for each due expression
+ * @param timestamp Fire time that was due
+ */
+typedef void (*mc_clock_cron_callback_t)(void * cron, void * context, int32_t timestamp);
+
+
+
+
+// ==================   Expression   ================ //
+
+/**
+ * @brief Compile a cron expression and return a pointer to it
+ * @return Cron object, NULL if expression is not valid
+ */
+void * Mc_Clock_Cron_New(const char * expression);
+
+/**
+ * @brief Free memory space of the cron object
+ *
+ */
+void Mc_Clock_Cron_Destroy(void * cron);
+
+/**
+ * @brief Verify if the clock minute matches the expression (seconds are ignored)
+ *
+ */
+uint8_t Mc_Clock_Cron_Match(void * cron, void * clock);
+
+/**
+ * @brief Get the first matching minute after the clock, skipping whole months, days and hours
+ * @return Timestamp of the next fire time, INT32_MIN if there is none before the end of the timestamp range
+ */
+int32_t Mc_Clock_Cron_Next(void * cron, void * clock);
+
+
+
+
+// ==================   Scheduler   ================ //
+
+/**
+ * @brief Creates a scheduler (min-heap of next fire times) and returns a pointer to it
+ *
+ */
+void * Mc_Clock_Cron_Scheduler_New(void);
+
+/**
+ * @brief Free memory space of the scheduler. Cron objects are not destroyed.
+ *
+ */
+void Mc_Clock_Cron_Scheduler_Destroy(void * scheduler);
+
+/**
+ * @brief Schedule a cron object from the clock time
+ * @return 0 on success, -1 if out of memory or expression never fires
+ */
+int Mc_Clock_Cron_Scheduler_Add(void * scheduler, void * cron, mc_clock_cron_callback_t callback, void * context, void * clock);
+
+/**
+ * @brief Remove a cron object from the scheduler
+ * @return 0 on success, -1 if cron is not scheduled
+ */
+int Mc_Clock_Cron_Scheduler_Remove(void * scheduler, void * cron);
+
+/**
+ * @brief Get the earliest fire time of the scheduler, INT32_MIN if scheduler is empty
+ *
+ */
+int32_t Mc_Clock_Cron_Scheduler_Peek(void * scheduler);
+
+/**
+ * @brief Call back every expression due at the clock time and schedule it again after the clock time.
+ * Missed fire times of an expression result in one call.
+ * @return Number of callbacks
+ */
+size_t Mc_Clock_Cron_Scheduler_Run(void * scheduler, void * clock);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _MC_CLOCK_CRON_H */
@@ -0,0 +1,403 @@
+/**
+ * @file mc_clock_duration.c
+ */
+
+#include "mc_clock_duration.h"
+#include "mc_clock.h"
+#include <string.h>
+
+#define SECONDS_PER_MINUTE  60
+#define SECONDS_PER_HOUR    3600
+#define SECONDS_PER_DAY     86400
+#define SECONDS_PER_WEEK    604800
+
+
+// ##############################  PRIVATE FUNCTIONS  ################################# //
+
+static const char digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+// write v (< 100) as two digits
+static char *put_2digits(char *p, uint8_t v)
+{
+    p[0] = digit_pairs[v * 2];
+    p[1] = digit_pairs[v * 2 + 1];
+    return p + 2;
+}// end put_2digits
+
+// write v in decimal without leading zeros
+static char *put_uint(char *p, uint64_t v)
+{
+    char digits[20];
+    int n = 0;
+
+    do
+    {
+        digits[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v != 0);
+
+    while (n > 0)
+        *p++ = digits[--n];
+
+    return p;
+}// end put_uint
+
+static char *put_unit(char *p, uint64_t v, char unit)
+{
+    p = put_uint(p, v);
+    *p = unit;
+    return p + 1;
+}// end put_unit
+
+static size_t format_duration(char *out, mc_clock_duration_t duration, mc_clock_duration_format_t format)
+{
+    mc_clock_duration_parts_t d = Mc_Clock_Duration_Split(duration);
+    char *p = out;
+
+    if (d.negative)
+        *p++ = '-';
+
+    switch (format)
+    {
+    case MC_CLOCK_DURATION_UNITS:
+        if (d.days)
+            p = put_unit(p, d.days, 'd');
+        if (d.hours)
+            p = put_unit(p, d.hours, 'h');
+        if (d.minutes)
+            p = put_unit(p, d.minutes, 'm');
+        if (d.seconds || duration == 0)
+            p = put_unit(p, d.seconds, 's');
+        break;
+
+    case MC_CLOCK_DURATION_ISO8601:
+        *p++ = 'P';
+        if (d.days)
+            p = put_unit(p, d.days, 'D');
+        if (d.hours || d.minutes || d.seconds || duration == 0)
+        {
+            *p++ = 'T';
+            if (d.hours)
+                p = put_unit(p, d.hours, 'H');
+            if (d.minutes)
+                p = put_unit(p, d.minutes, 'M');
+            if (d.seconds || duration == 0)
+                p = put_unit(p, d.seconds, 'S');
+        }
+        break;
+
+    default:
+        if (d.days)
+        {
+            p = put_unit(p, d.days, 'd');
+            *p++ = ' ';
+        }
+        p = put_2digits(p, d.hours);
+        *p++ = ':';
+        p = put_2digits(p, d.minutes);
+        *p++ = ':';
+        p = put_2digits(p, d.seconds);
+        break;
+    }
+
+    *p = '\0';
+    return (size_t)(p - out);
+}// end format_duration
+
+// read decimal digits. 0 if there is no digit or on overflow
+static uint8_t parse_uint(const char **text, uint64_t *value)
+{
+    const char *p = *text;
+    uint64_t v = 0;
+
+    if (*p < '0' || *p > '9')
+        return 0;
+
+    while (*p >= '0' && *p <= '9')
+    {
+        unsigned d = (unsigned)(*p - '0');
+        if (v > (UINT64_MAX - d) / 10)
+            return 0;
+        v = v * 10 + d;
+        p++;
+    }
+
+    *text = p;
+    *value = v;
+    return 1;
+}// end parse_uint
+
+// total += value * unit. 0 if total would go over limit
+static uint8_t add_unit(uint64_t *total, uint64_t value, uint64_t unit, uint64_t limit)
+{
+    if (value > limit / unit || *total > limit - value * unit)
+        return 0;
+
+    *total += value * unit;
+    return 1;
+}// end add_unit
+
+// "P3DT4H5M6S", "P2W" (text after 'P')
+static int parse_iso8601(const char *p, uint64_t *total, uint64_t limit)
+{
+    uint64_t value;
+    uint8_t components = 0;
+
+    // date part: weeks and days only
+    while (*p != '\0' && *p != 'T')
+    {
+        if (!parse_uint(&p, &value))
+            return -1;
+
+        if (*p == 'W' && components == 0)
+        {
+            if (!add_unit(total, value, SECONDS_PER_WEEK, limit))
+                return -1;
+        }
+        else if (*p == 'D')
+        {
+            if (!add_unit(total, value, SECONDS_PER_DAY, limit))
+                return -1;
+            p++;
+            components++;
+            break;
+        }
+        else
+        {
+            return -1;
+        }
+
+        p++;
+        components++;
+    }
+
+    if (*p == 'T')
+    {
+        static const char units[3] = {'H', 'M', 'S'};
+        static const uint64_t seconds[3] = {SECONDS_PER_HOUR, SECONDS_PER_MINUTE, 1};
+        int next = 0;
+        uint8_t time_components = 0;
+
+        p++;
+        while (*p != '\0')
+        {
+            if (!parse_uint(&p, &value))
+                return -1;
+
+            // units in order, each one at most once
+            while (next < 3 && units[next] != *p)
+                next++;
+            if (next == 3 || !add_unit(total, value, seconds[next], limit))
+                return -1;
+
+            next++;
+            p++;
+            time_components++;
+        }
+
+        if (time_components == 0)
+            return -1;
+        components += time_components;
+    }
+
+    return (*p == '\0' && components > 0) ? 0 : -1;
+}// end parse_iso8601
+
+// "3d4h5m6s", "3d 4h", "3d 04:05:06", "04:05"
+static int parse_compact(const char *p, uint64_t *total, uint64_t limit)
+{
+    static const char units[5] = {'w', 'd', 'h', 'm', 's'};
+    static const uint64_t seconds[5] = {SECONDS_PER_WEEK, SECONDS_PER_DAY, SECONDS_PER_HOUR, SECONDS_PER_MINUTE, 1};
+    int next = 0;
+    uint8_t components = 0;
+    uint64_t value;
+
+    while (1)
+    {
+        while (*p == ' ')
+            p++;
+        if (*p == '\0')
+            break;
+
+        if (!parse_uint(&p, &value))
+            return -1;
+
+        // clock time ends the text: h:mm or h:mm:ss
+        if (*p == ':')
+        {
+            uint64_t minutes;
+            uint64_t secs = 0;
+
+            // hours, minutes or seconds were already given as units
+            if (next > 2)
+                return -1;
+
+            p++;
+            if (!parse_uint(&p, &minutes) || minutes >= 60)
+                return -1;
+
+            if (*p == ':')
+            {
+                p++;
+                if (!parse_uint(&p, &secs) || secs >= 60)
+                    return -1;
+            }
+
+            while (*p == ' ')
+                p++;
+
+            if (*p != '\0' || !add_unit(total, value, SECONDS_PER_HOUR, limit) || !add_unit(total, minutes * 60 + secs, 1, limit))
+                return -1;
+
+            return 0;
+        }
+
+        // units in order, each one at most once
+        while (next < 5 && units[next] != *p)
+            next++;
+        if (next == 5 || !add_unit(total, value, seconds[next], limit))
+            return -1;
+
+        next++;
+        p++;
+        components++;
+    }
+
+    return components > 0 ? 0 : -1;
+}// end parse_compact
+
+
+
+
+// ##############################  PUBLIC FUNCTIONS  ################################# //
+
+
+
+
+// ==================   Clock Arithmetic   ================ //
+
+mc_clock_duration_t Mc_Clock_Duration_Between(void *from, void *to)
+{
+    return (mc_clock_duration_t)Mc_Clock_Get_Timestamp(to) - Mc_Clock_Get_Timestamp(from);
+}// end Mc_Clock_Duration_Between
+
+void Mc_Clock_Add_Duration(void *clock, mc_clock_duration_t duration)
+{
+    int64_t timestamp = Mc_Clock_Get_Timestamp(clock);
+
+    // saturate instead of overflowing int32_t
+    if (duration > INT32_MAX - timestamp)
+        timestamp = INT32_MAX;
+    else if (duration < INT32_MIN - timestamp)
+        timestamp = INT32_MIN;
+    else
+        timestamp += duration;
+
+    Mc_Clock_Set_Timestamp(clock, (int32_t)timestamp);
+}// end Mc_Clock_Add_Duration
+
+void Mc_Clock_Subtract_Duration(void *clock, mc_clock_duration_t duration)
+{
+    Mc_Clock_Add_Duration(clock, (duration == INT64_MIN) ? INT64_MAX : -duration);
+}// end Mc_Clock_Subtract_Duration
+
+
+
+
+// ==================   Decomposition   ================ //
+
+mc_clock_duration_parts_t Mc_Clock_Duration_Split(mc_clock_duration_t duration)
+{
+    mc_clock_duration_parts_t d;
+    uint64_t magnitude = (duration < 0) ? 0 - (uint64_t)duration : (uint64_t)duration;
+
+    d.negative = duration < 0;
+    d.days = magnitude / SECONDS_PER_DAY;
+
+    Mc_Clock_Split_Time_Of_Day((uint32_t)(magnitude - d.days * SECONDS_PER_DAY), &d.hours, &d.minutes, &d.seconds);
+
+    return d;
+}// end Mc_Clock_Duration_Split
+
+mc_clock_duration_t Mc_Clock_Duration_Join(const mc_clock_duration_parts_t *parts)
+{
+    // magnitude up to INT64_MAX, or INT64_MAX + 1 for INT64_MIN. Saturates past it
+    uint64_t limit = parts->negative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX;
+    uint64_t total = 0;
+
+    if (!add_unit(&total, parts->days, SECONDS_PER_DAY, limit) || !add_unit(&total, parts->hours, SECONDS_PER_HOUR, limit)
+        || !add_unit(&total, parts->minutes, SECONDS_PER_MINUTE, limit) || !add_unit(&total, parts->seconds, 1, limit))
+        total = limit;
+
+    return (parts->negative && total > 0) ? -(int64_t)(total - 1) - 1 : (int64_t)total;
+}// end Mc_Clock_Duration_Join
+
+
+
+
+// ==================   Text   ================ //
+
+size_t Mc_Clock_Duration_Format(char *buffer, size_t size, mc_clock_duration_t duration, mc_clock_duration_format_t format)
+{
+    char text[MC_CLOCK_DURATION_MAX_LENGTH];
+
+    // large enough buffer: no copy
+    if (size >= MC_CLOCK_DURATION_MAX_LENGTH)
+        return format_duration(buffer, duration, format);
+
+    size_t length = format_duration(text, duration, format);
+    if (length >= size)
+        return 0;
+
+    memcpy(buffer, text, length + 1);
+    return length;
+}// end Mc_Clock_Duration_Format
+
+size_t Mc_Clock_Duration_Format_Array(char *buffer, size_t stride, const mc_clock_duration_t *durations,
+                                      size_t count, mc_clock_duration_format_t format)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        if (Mc_Clock_Duration_Format(buffer + i * stride, stride, durations[i], format) == 0)
+            return i;
+    }
+
+    return count;
+}// end Mc_Clock_Duration_Format_Array
+
+int Mc_Clock_Duration_Parse(const char *text, mc_clock_duration_t *duration)
+{
+    uint64_t total = 0;
+    uint8_t negative = 0;
+    int result;
+
+    if (*text == '-')
+    {
+        negative = 1;
+        text++;
+    }
+
+    // magnitude of INT64_MIN is one more than INT64_MAX
+    uint64_t limit = negative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX;
+
+    if (*text == 'P')
+        result = parse_iso8601(text + 1, &total, limit);
+    else
+        result = parse_compact(text, &total, limit);
+
+    if (result != 0)
+        return -1;
+
+    *duration = (negative && total > 0) ? -(int64_t)(total - 1) - 1 : (int64_t)total;
+    return 0;
+}// end Mc_Clock_Duration_Parse
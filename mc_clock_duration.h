@@ -0,0 +1,132 @@
+/**
+ * @file mc_clock_duration.h
+ * @brief Signed durations in seconds: clock arithmetic, formatting and parsing without stdio
+ *
+ * Example of usage:
+
+    char text[MC_CLOCK_DURATION_MAX_LENGTH];
+
+    mc_clock_duration_t uptime = Mc_Clock_Duration_Between(boot_clock, clock);
+    Mc_Clock_Duration_Format(text, sizeof(text), uptime, MC_CLOCK_DURATION_CLOCK);     // "3d 04:05:06"
+    Mc_Clock_Duration_Format(text, sizeof(text), uptime, MC_CLOCK_DURATION_ISO8601);   // "P3DT4H5M6S"
+
+    mc_clock_duration_t d;
+    if (Mc_Clock_Duration_Parse("PT3H4M", &d) == 0)
+        Mc_Clock_Add_Duration(clock, d);
+ */
+
+#ifndef _MC_CLOCK_DURATION_H
+#define _MC_CLOCK_DURATION_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Duration in seconds (negative when going back in time)
+ */
+typedef int64_t mc_clock_duration_t;
+
+/**
+ * @brief Buffer size that fits any formatted duration, including the terminating '\0'
+ */
+#define MC_CLOCK_DURATION_MAX_LENGTH 32
+
+/**
+ * @brief Text forms of a duration
+ */
+typedef enum
+{
+    MC_CLOCK_DURATION_CLOCK = 0,    ///< "3d 04:05:06", days omitted when 0: "04:05:06"
+    MC_CLOCK_DURATION_UNITS,        ///< "3d4h5m6s", zero units omitted: "3h4m", "0s"
+    MC_CLOCK_DURATION_ISO8601       ///< "P3DT4H5M6S", zero units omitted: "PT3H4M", "PT0S"
+} mc_clock_duration_format_t;
+
+/**
+ * @brief Duration split in days, hours, minutes and seconds
+ */
+typedef struct
+{
+    uint8_t negative;
+    uint64_t days;
+    uint8_t hours;
+    uint8_t minutes;
+    uint8_t seconds;
+} mc_clock_duration_parts_t;
+
+
+
+
+// ==================   Clock Arithmetic   ================ //
+
+/**
+ * @brief Get duration from clock <from> to clock <to> (to - from)
+ *
+ */
+mc_clock_duration_t Mc_Clock_Duration_Between(void * from, void * to);
+
+/**
+ * @brief Move clock forward by duration. Timestamp saturates at int32_t limits.
+ *
+ */
+void Mc_Clock_Add_Duration(void * clock, mc_clock_duration_t duration);
+
+/**
+ * @brief Move clock back by duration. Timestamp saturates at int32_t limits.
+ *
+ */
+void Mc_Clock_Subtract_Duration(void * clock, mc_clock_duration_t duration);
+
+
+
+
+// ==================   Decomposition   ================ //
+
+/**
+ * @brief Split duration in days, hours, minutes and seconds (one division, the rest by multiply and shift)
+ *
+ */
+mc_clock_duration_parts_t Mc_Clock_Duration_Split(mc_clock_duration_t duration);
+
+/**
+ * @brief Build a duration from its parts (Join(Split(d)) == d for every duration, INT64_MIN included)
+ * @return Duration, saturated to INT64_MAX (INT64_MIN if negative) when the parts are past the int64_t range
+ */
+mc_clock_duration_t Mc_Clock_Duration_Join(const mc_clock_duration_parts_t * parts);
+
+
+
+
+// ==================   Text   ================ //
+
+/**
+ * @brief Write duration into buffer as text, terminated by '\0'
+ * @return Length of the text, 0 if buffer is too small (MC_CLOCK_DURATION_MAX_LENGTH always fits)
+ */
+size_t Mc_Clock_Duration_Format(char * buffer, size_t size, mc_clock_duration_t duration, mc_clock_duration_format_t format);
+
+/**
+ * @brief Format <count> durations into consecutive slots of <stride> bytes, each terminated by '\0'
+ * @return Number of durations written (stops at the first one that doesn't fit its slot)
+ */
+size_t Mc_Clock_Duration_Format_Array(char * buffer, size_t stride, const mc_clock_duration_t * durations,
+                                      size_t count, mc_clock_duration_format_t format);
+
+/**
+ * @brief Parse a duration in any of the formats ("3d 04:05:06", "04:05", "3d4h5m6s", "P3DT4H5M6S", "P2W"),
+ * with an optional leading '-'. ISO 8601 years and months are rejected (no fixed length).
+ * Any text written by Mc_Clock_Duration_Format() parses back to the same value, INT64_MIN included.
+ * @return 0 on success, -1 if text is not a valid duration
+ */
+int Mc_Clock_Duration_Parse(const char * text, mc_clock_duration_t * duration);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _MC_CLOCK_DURATION_H */
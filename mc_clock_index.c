@@ -0,0 +1,223 @@
+/**
+ * @file mc_clock_index.c
+ */
+
+#include "mc_clock_index.h"
+#include "mc_clock.h"
+#include <stdlib.h>
+
+#define SECONDS_PER_DAY 86400LL
+
+typedef struct
+{
+    const int32_t *timestamps;
+    size_t count;
+    int64_t first_day;  // day number (days since 1/jan/1970) of offsets[0]
+    size_t days;        // days from first to last timestamp
+    size_t *offsets;    // offsets[d]: position of the first timestamp of day first_day + d. offsets[days] = count
+} clock_index_t;
+
+
+// ##############################  PRIVATE FUNCTIONS  ################################# //
+
+// lower bound for keys out of int32 range (exclusive range ends)
+static size_t lower_bound_64(const int32_t *timestamps, size_t count, int64_t timestamp)
+{
+    if (timestamp > INT32_MAX)
+        return count;
+    if (timestamp < INT32_MIN)
+        return 0;
+
+    return Mc_Clock_Lower_Bound(timestamps, count, (int32_t)timestamp);
+}// end lower_bound_64
+
+static size_t index_position(const clock_index_t *ix, int64_t timestamp)
+{
+    int64_t day = Mc_Clock_Timestamp_To_Days(timestamp) - ix->first_day;
+
+    if (day < 0)
+        return 0;
+    if (day >= (int64_t)ix->days)
+        return ix->count;
+
+    size_t lo = ix->offsets[day];
+
+    // day aligned: no search
+    if (timestamp == (ix->first_day + day) * SECONDS_PER_DAY)
+        return lo;
+
+    return lo + lower_bound_64(ix->timestamps + lo, ix->offsets[day + 1] - lo, timestamp);
+}// end index_position
+
+static size_t index_range(const clock_index_t *ix, int64_t from, int64_t to, size_t *first)
+{
+    size_t lo = index_position(ix, from);
+    size_t hi = (to > from) ? index_position(ix, to) : lo;
+
+    *first = lo;
+    return hi - lo;
+}// end index_range
+
+// timestamp of the date at 12:00:00 AM, out of int32 range if needed. 0 if the date is not valid
+static uint8_t date_start(uint16_t year, uint8_t month, uint8_t day, int64_t *start)
+{
+    // year 0 is out of Mc_Clock_Date_To_Days() range
+    if (year == 0 || day == 0 || day > Mc_Clock_Days_In_Month(month, year))
+        return 0;
+
+    *start = Mc_Clock_Date_To_Days(year, month, day) * SECONDS_PER_DAY;
+    return 1;
+}// end date_start
+
+// [from, to) of the days from..to, both included. 0 if a date is not valid
+static uint8_t dates_range(uint16_t from_year, uint8_t from_month, uint8_t from_day,
+                           uint16_t to_year, uint8_t to_month, uint8_t to_day, int64_t *from, int64_t *to)
+{
+    if (!date_start(from_year, from_month, from_day, from) || !date_start(to_year, to_month, to_day, to))
+        return 0;
+
+    *to += SECONDS_PER_DAY;
+    return 1;
+}// end dates_range
+
+
+
+
+// ##############################  PUBLIC FUNCTIONS  ################################# //
+
+
+
+
+// ==================   Search   ================ //
+
+size_t Mc_Clock_Lower_Bound(const int32_t *timestamps, size_t count, int32_t timestamp)
+{
+    const int32_t *base = timestamps;
+
+    if (count == 0)
+        return 0;
+
+    // answer stays in [base, base + count]; the compare becomes a conditional move
+    while (count > 1)
+    {
+        size_t half = count / 2;
+#if defined(__GNUC__)
+        __builtin_prefetch(base + half / 2);
+        __builtin_prefetch(base + half + half / 2);
+#endif
+        base = (base[half] < timestamp) ? base + half : base;
+        count -= half;
+    }
+
+    return (size_t)(base - timestamps) + (*base < timestamp);
+}// end Mc_Clock_Lower_Bound
+
+size_t Mc_Clock_Find_Range(const int32_t *timestamps, size_t count, int32_t from, int32_t to, size_t *first)
+{
+    size_t lo = Mc_Clock_Lower_Bound(timestamps, count, from);
+    size_t hi = (to > from) ? lo + Mc_Clock_Lower_Bound(timestamps + lo, count - lo, to) : lo;
+
+    *first = lo;
+    return hi - lo;
+}// end Mc_Clock_Find_Range
+
+size_t Mc_Clock_Find_Dates(const int32_t *timestamps, size_t count,
+                           uint16_t from_year, uint8_t from_month, uint8_t from_day,
+                           uint16_t to_year, uint8_t to_month, uint8_t to_day, size_t *first)
+{
+    int64_t from;
+    int64_t to;
+
+    *first = 0;
+    if (!dates_range(from_year, from_month, from_day, to_year, to_month, to_day, &from, &to) || to <= from)
+        return 0;
+
+    size_t lo = lower_bound_64(timestamps, count, from);
+    size_t hi = lo + lower_bound_64(timestamps + lo, count - lo, to);
+
+    *first = lo;
+    return hi - lo;
+}// end Mc_Clock_Find_Dates
+
+
+
+
+// ==================   Day Index   ================ //
+
+void *Mc_Clock_Index_New(const int32_t *timestamps, size_t count)
+{
+    clock_index_t *p = malloc(sizeof(clock_index_t));
+    if (p == NULL)
+        return NULL;
+
+    p->timestamps = timestamps;
+    p->count = count;
+    p->first_day = (count > 0) ? Mc_Clock_Timestamp_To_Days(timestamps[0]) : 0;
+    p->days = (count > 0) ? (size_t)(Mc_Clock_Timestamp_To_Days(timestamps[count - 1]) - p->first_day + 1) : 0;
+
+    // int32 timestamps span less than 50000 days
+    p->offsets = malloc((p->days + 1) * sizeof(size_t));
+    if (p->offsets == NULL)
+    {
+        free(p);
+        return NULL;
+    }
+
+    // each day starts where the previous one ended
+    size_t position = 0;
+    for (size_t d = 0; d < p->days; d++)
+    {
+        int64_t start = (p->first_day + (int64_t)d) * SECONDS_PER_DAY;
+        position += lower_bound_64(timestamps + position, count - position, start);
+        p->offsets[d] = position;
+    }
+    p->offsets[p->days] = count;
+
+    return p;
+}// end Mc_Clock_Index_New
+
+void Mc_Clock_Index_Destroy(void *index)
+{
+    clock_index_t *ix = index;
+
+    if (ix == NULL)
+        return;
+
+    free(ix->offsets);
+    free(ix);
+}// end Mc_Clock_Index_Destroy
+
+size_t Mc_Clock_Index_Find_Range(void *index, int32_t from, int32_t to, size_t *first)
+{
+    return index_range(index, from, to, first);
+}// end Mc_Clock_Index_Find_Range
+
+size_t Mc_Clock_Index_Find_Dates(void *index,
+                                 uint16_t from_year, uint8_t from_month, uint8_t from_day,
+                                 uint16_t to_year, uint8_t to_month, uint8_t to_day, size_t *first)
+{
+    int64_t from;
+    int64_t to;
+
+    *first = 0;
+    if (!dates_range(from_year, from_month, from_day, to_year, to_month, to_day, &from, &to))
+        return 0;
+
+    return index_range(index, from, to, first);
+}// end Mc_Clock_Index_Find_Dates
+
+size_t Mc_Clock_Index_Find_Day(void *index, uint16_t year, uint8_t month, uint8_t day, size_t *first)
+{
+    return Mc_Clock_Index_Find_Dates(index, year, month, day, year, month, day, first);
+}// end Mc_Clock_Index_Find_Day
+
+size_t Mc_Clock_Index_Find_Month(void *index, uint16_t year, uint8_t month, size_t *first)
+{
+    int64_t from;
+
+    *first = 0;
+    if (!date_start(year, month, 1, &from))
+        return 0;
+
+    return index_range(index, from, from + Mc_Clock_Days_In_Month(month, year) * SECONDS_PER_DAY, first);
+}// end Mc_Clock_Index_Find_Month
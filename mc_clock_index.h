@@ -0,0 +1,102 @@
+/**
+ * @file mc_clock_index.h
+ * @brief Date range lookup over sorted arrays of epoch timestamps
+ *
+ * Example of usage:
+
+    // events: sorted int32_t timestamps
+    size_t first;
+    size_t count = Mc_Clock_Find_Dates(events, n, 2026, 3, 14, 2026, 3, 14, &first);
+
+    // repeated day/month queries: per-day offset index, O(1) per query
+    void * index = Mc_Clock_Index_New(events, n);
+    count = Mc_Clock_Index_Find_Month(index, 2026, 3, &first);
+    Mc_Clock_Index_Destroy(index);
+ */
+
+#ifndef _MC_CLOCK_INDEX_H
+#define _MC_CLOCK_INDEX_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+// ==================   Search   ================ //
+
+/**
+ * @brief Branchless binary search: position of the first timestamp >= <timestamp>
+ *
+ */
+size_t Mc_Clock_Lower_Bound(const int32_t * timestamps, size_t count, int32_t timestamp);
+
+/**
+ * @brief Find the timestamps in [from, to)
+ * @param first Receives the position of the first timestamp in range
+ * @return Number of timestamps in range
+ */
+size_t Mc_Clock_Find_Range(const int32_t * timestamps, size_t count, int32_t from, int32_t to, size_t * first);
+
+/**
+ * @brief Find the timestamps from day <from> 12:00:00 AM up to the end of day <to> (both days included)
+ * @param first Receives the position of the first timestamp in range
+ * @return Number of timestamps in range, 0 if a date is not valid
+ */
+size_t Mc_Clock_Find_Dates(const int32_t * timestamps, size_t count,
+                           uint16_t from_year, uint8_t from_month, uint8_t from_day,
+                           uint16_t to_year, uint8_t to_month, uint8_t to_day, size_t * first);
+
+
+
+
+// ==================   Day Index   ================ //
+
+/**
+ * @brief Build a per-day offset index over a sorted timestamp array and return a pointer to it
+ * @note The array is not copied: it must stay valid and unchanged while the index is used.
+ * @return Index object, NULL if out of memory
+ */
+void * Mc_Clock_Index_New(const int32_t * timestamps, size_t count);
+
+/**
+ * @brief Free memory space of the index object
+ *
+ */
+void Mc_Clock_Index_Destroy(void * index);
+
+/**
+ * @brief Find the timestamps in [from, to). Day aligned bounds take O(1).
+ *
+ */
+size_t Mc_Clock_Index_Find_Range(void * index, int32_t from, int32_t to, size_t * first);
+
+/**
+ * @brief Same as Mc_Clock_Find_Dates(), in O(1)
+ *
+ */
+size_t Mc_Clock_Index_Find_Dates(void * index,
+                                 uint16_t from_year, uint8_t from_month, uint8_t from_day,
+                                 uint16_t to_year, uint8_t to_month, uint8_t to_day, size_t * first);
+
+/**
+ * @brief Find the timestamps of a day, in O(1)
+ *
+ */
+size_t Mc_Clock_Index_Find_Day(void * index, uint16_t year, uint8_t month, uint8_t day, size_t * first);
+
+/**
+ * @brief Find the timestamps of a month, in O(1)
+ *
+ */
+size_t Mc_Clock_Index_Find_Month(void * index, uint16_t year, uint8_t month, size_t * first);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _MC_CLOCK_INDEX_H */
@@ -0,0 +1,206 @@
+/**
+ * @file test_rtc.c
+ * @brief Host-side RTC register fixtures for Mc_Clock_From_RTC_BCD() and Mc_Clock_To_RTC_BCD()
+ */
+
+#include "../mc_clock.h"
+#include <stdio.h>
+#include <string.h>
+
+static int failures = 0;
+
+#define CHECK(condition)                                                    \
+    do                                                                      \
+    {                                                                       \
+        if (!(condition))                                                   \
+        {                                                                   \
+            printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+            failures++;                                                     \
+        }                                                                   \
+    } while (0)
+
+static void check_datetime(void *clock, uint16_t year, uint8_t month, uint8_t day,
+                           uint8_t hour, uint8_t minute, uint8_t second)
+{
+    CHECK(Mc_Clock_Get_Year(clock) == year);
+    CHECK(Mc_Clock_Get_Month(clock) == month);
+    CHECK(Mc_Clock_Get_Day(clock) == day);
+    CHECK(Mc_Clock_Get_Hour(clock) == hour);
+    CHECK(Mc_Clock_Get_Minute(clock) == minute);
+    CHECK(Mc_Clock_Get_Second(clock) == second);
+    CHECK(Mc_Clock_Get_Timestamp(clock) == Mc_Clock_Date_To_Timestamp(year, month, day, hour, minute, second));
+}// end check_datetime
+
+
+
+
+// ==================   DS3231   ================ //
+
+static void test_ds3231_24h(void *clock)
+{
+    // seconds, minutes, hours, weekday, date, month, year
+    const uint8_t registers[MC_CLOCK_RTC_BLOCK_SIZE] = {0x56, 0x34, 0x12, 0x06, 0x15, 0x03, 0x24};
+
+    CHECK(Mc_Clock_From_RTC_BCD(clock, registers, MC_CLOCK_RTC_DS3231) == 0);
+    check_datetime(clock, 2024, 3, 15, 12, 34, 56);
+}// end test_ds3231_24h
+
+static void test_ds3231_12h(void *clock)
+{
+    // bit 6 = 12 hour mode, bit 5 = PM
+    uint8_t registers[MC_CLOCK_RTC_BLOCK_SIZE] = {0x00, 0x00, 0x52, 0x02, 0x01, 0x01, 0x24};
+
+    CHECK(Mc_Clock_From_RTC_BCD(clock, registers, MC_CLOCK_RTC_DS3231) == 0);
+    check_datetime(clock, 2024, 1, 1, 0, 0, 0);     // 12 AM
+
+    registers[2] = 0x51;
+    CHECK(Mc_Clock_From_RTC_BCD(clock, registers, MC_CLOCK_RTC_DS3231) == 0);
+    CHECK(Mc_Clock_Get_Hour(clock) == 11);          // 11 AM
+
+    registers[2] = 0x72;
+    CHECK(Mc_Clock_From_RTC_BCD(clock, registers, MC_CLOCK_RTC_DS3231) == 0);
+    CHECK(Mc_Clock_Get_Hour(clock) == 12);          // 12 PM
+
+    registers[2] = 0x71;
+    CHECK(Mc_Clock_From_RTC_BCD(clock, registers, MC_CLOCK_RTC_DS3231) == 0);
+    CHECK(Mc_Clock_Get_Hour(clock) == 23);          // 11 PM
+
+    registers[2] = 0x40;                            // hour 0 in 12 hour mode
+    CHECK(Mc_Clock_From_RTC_BCD(clock, registers, MC_CLOCK_RTC_DS3231) == -1);
+    registers[2] = 0x53;                            // hour 13 in 12 hour mode
+    CHECK(Mc_Clock_From_RTC_BCD(clock, registers, MC_CLOCK_RTC_DS3231) == -1);
+}// end test_ds3231_12h
+
+
+
+
+// ==================   DS1307   ================ //
+
+static void test_ds1307_clock_halt(void *clock)
+{
+    // seconds bit 7 = clock halt: oscillator stopped, time is stale
+    uint8_t registers[MC_CLOCK_RTC_BLOCK_SIZE] = {0x80 | 0x56, 0x34, 0x12, 0x06, 0x15, 0x03, 0x24};
+
+    Mc_Clock_Set_Timestamp(clock, 1000);
+    CHECK(Mc_Clock_From_RTC_BCD(clock, registers, MC_CLOCK_RTC_DS1307) == -1);
+    CHECK(Mc_Clock_Get_Timestamp(clock) == 1000);
+
+    registers[0] = 0x56;
+    CHECK(Mc_Clock_From_RTC_BCD(clock, registers, MC_CLOCK_RTC_DS1307) == 0);
+    check_datetime(clock, 2024, 3, 15, 12, 34, 56);
+}// end test_ds1307_clock_halt
+
+
+
+
+// ==================   PCF8563   ================ //
+
+static void test_pcf8563_19xx(void *clock)
+{
+    // seconds, minutes, hours, days, weekday, month (bit 7 = 19xx), year
+    const uint8_t registers[MC_CLOCK_RTC_BLOCK_SIZE] = {0x58, 0x59, 0x23, 0x31, 0x05, 0x92, 0x99};
+
+    CHECK(Mc_Clock_From_RTC_BCD(clock, registers, MC_CLOCK_RTC_PCF8563) == 0);
+    check_datetime(clock, 1999, 12, 31, 23, 59, 58);
+}// end test_pcf8563_19xx
+
+static void test_pcf8563_voltage_low(void *clock)
+{
+    const uint8_t registers[MC_CLOCK_RTC_BLOCK_SIZE] = {0x80 | 0x10, 0x00, 0x08, 0x01, 0x01, 0x06, 0x24};
+
+    Mc_Clock_Set_Timestamp(clock, 1000);
+    CHECK(Mc_Clock_From_RTC_BCD(clock, registers, MC_CLOCK_RTC_PCF8563) == -1);
+    CHECK(Mc_Clock_Get_Timestamp(clock) == 1000);
+}// end test_pcf8563_voltage_low
+
+
+
+
+// ==================   Invalid Registers   ================ //
+
+static void test_invalid(void *clock)
+{
+    const uint8_t nibble[MC_CLOCK_RTC_BLOCK_SIZE] = {0x5A, 0x00, 0x00, 0x01, 0x01, 0x01, 0x24};
+    const uint8_t minute[MC_CLOCK_RTC_BLOCK_SIZE] = {0x00, 0x60, 0x00, 0x01, 0x01, 0x01, 0x24};
+    const uint8_t february[MC_CLOCK_RTC_BLOCK_SIZE] = {0x00, 0x00, 0x00, 0x01, 0x31, 0x02, 0x24};
+    const uint8_t leap[MC_CLOCK_RTC_BLOCK_SIZE] = {0x00, 0x00, 0x00, 0x01, 0x29, 0x02, 0x23};
+    const uint8_t month[MC_CLOCK_RTC_BLOCK_SIZE] = {0x00, 0x00, 0x00, 0x01, 0x01, 0x13, 0x24};
+
+    Mc_Clock_Set_Timestamp(clock, 1000);
+    CHECK(Mc_Clock_From_RTC_BCD(clock, nibble, MC_CLOCK_RTC_DS3231) == -1);
+    CHECK(Mc_Clock_From_RTC_BCD(clock, minute, MC_CLOCK_RTC_DS3231) == -1);
+    CHECK(Mc_Clock_From_RTC_BCD(clock, february, MC_CLOCK_RTC_DS3231) == -1);
+    CHECK(Mc_Clock_From_RTC_BCD(clock, leap, MC_CLOCK_RTC_DS3231) == -1);
+    CHECK(Mc_Clock_From_RTC_BCD(clock, month, MC_CLOCK_RTC_DS3231) == -1);
+    CHECK(Mc_Clock_Get_Timestamp(clock) == 1000);
+}// end test_invalid
+
+
+
+
+// ==================   Write   ================ //
+
+static void test_round_trip(void *clock, void *copy)
+{
+    uint8_t registers[MC_CLOCK_RTC_BLOCK_SIZE];
+
+    // thursday 29/feb/2024 13:05:09
+    Mc_Clock_Set_Timestamp(clock, Mc_Clock_Date_To_Timestamp(2024, 2, 29, 13, 5, 9));
+
+    CHECK(Mc_Clock_To_RTC_BCD(clock, registers, MC_CLOCK_RTC_DS3231) == 0);
+    CHECK(memcmp(registers, "\x09\x05\x13\x05\x29\x02\x24", MC_CLOCK_RTC_BLOCK_SIZE) == 0);
+    CHECK(Mc_Clock_From_RTC_BCD(copy, registers, MC_CLOCK_RTC_DS3231) == 0);
+    CHECK(Mc_Clock_Get_Timestamp(copy) == Mc_Clock_Get_Timestamp(clock));
+
+    CHECK(Mc_Clock_To_RTC_BCD(clock, registers, MC_CLOCK_RTC_DS3231_12H) == 0);
+    CHECK(registers[2] == 0x61);
+    CHECK(Mc_Clock_From_RTC_BCD(copy, registers, MC_CLOCK_RTC_DS3231) == 0);
+    CHECK(Mc_Clock_Get_Timestamp(copy) == Mc_Clock_Get_Timestamp(clock));
+
+    CHECK(Mc_Clock_To_RTC_BCD(clock, registers, MC_CLOCK_RTC_DS1307) == 0);
+    CHECK(memcmp(registers, "\x09\x05\x13\x05\x29\x02\x24", MC_CLOCK_RTC_BLOCK_SIZE) == 0);
+    CHECK(Mc_Clock_From_RTC_BCD(copy, registers, MC_CLOCK_RTC_DS1307) == 0);
+    CHECK(Mc_Clock_Get_Timestamp(copy) == Mc_Clock_Get_Timestamp(clock));
+
+    CHECK(Mc_Clock_To_RTC_BCD(clock, registers, MC_CLOCK_RTC_PCF8563) == 0);
+    CHECK(memcmp(registers, "\x09\x05\x13\x29\x04\x02\x24", MC_CLOCK_RTC_BLOCK_SIZE) == 0);
+    CHECK(Mc_Clock_From_RTC_BCD(copy, registers, MC_CLOCK_RTC_PCF8563) == 0);
+    CHECK(Mc_Clock_Get_Timestamp(copy) == Mc_Clock_Get_Timestamp(clock));
+
+    // sunday 20/jul/1969 20:17:40: century bit on the PCF8563, out of range on the DS3231
+    Mc_Clock_Set_Timestamp(clock, Mc_Clock_Date_To_Timestamp(1969, 7, 20, 20, 17, 40));
+
+    CHECK(Mc_Clock_To_RTC_BCD(clock, registers, MC_CLOCK_RTC_PCF8563) == 0);
+    CHECK(memcmp(registers, "\x40\x17\x20\x20\x00\x87\x69", MC_CLOCK_RTC_BLOCK_SIZE) == 0);
+    CHECK(Mc_Clock_From_RTC_BCD(copy, registers, MC_CLOCK_RTC_PCF8563) == 0);
+    CHECK(Mc_Clock_Get_Timestamp(copy) == Mc_Clock_Get_Timestamp(clock));
+
+    memset(registers, 0xEE, sizeof(registers));
+    CHECK(Mc_Clock_To_RTC_BCD(clock, registers, MC_CLOCK_RTC_DS3231) == -1);
+    CHECK(Mc_Clock_To_RTC_BCD(clock, registers, MC_CLOCK_RTC_DS3231_12H) == -1);
+    CHECK(Mc_Clock_To_RTC_BCD(clock, registers, MC_CLOCK_RTC_DS1307) == -1);
+    CHECK(registers[0] == 0xEE && registers[6] == 0xEE);
+}// end test_round_trip
+
+
+
+
+int main(void)
+{
+    void *clock = Mc_Clock_New();
+    void *copy = Mc_Clock_New();
+
+    test_ds3231_24h(clock);
+    test_ds3231_12h(clock);
+    test_ds1307_clock_halt(clock);
+    test_pcf8563_19xx(clock);
+    test_pcf8563_voltage_low(clock);
+    test_invalid(clock);
+    test_round_trip(clock, copy);
+
+    Mc_Clock_Destroy(clock);
+    Mc_Clock_Destroy(copy);
+
+    printf("test_rtc: %s (%d failures)\n", failures ? "FAIL" : "OK", failures);
+    return failures ? 1 : 0;
+}// end main